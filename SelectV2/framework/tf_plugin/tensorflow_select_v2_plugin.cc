@@ -15,9 +15,25 @@ rights reserved.
 #include "register/register.h"
 
 namespace domi {
+// tf的Select在condition为1维时按行选择（condition对齐x的第0维），和SelectV2的右对齐广播不同，用row_select区分
+Status ParseParamsSelect(const ge::Operator& op_src, ge::Operator& op_dest)
+{
+    if (AutoMappingByOpFn(op_src, op_dest) != SUCCESS) {
+        return FAILED;
+    }
+    op_dest.SetAttr("row_select", true);
+    return SUCCESS;
+}
+
 // register op info to GE
 REGISTER_CUSTOM_OP("SelectV2")
     .FrameworkType(TENSORFLOW)   // type: CAFFE, TENSORFLOW
     .OriginOpType("SelectV2")      // name in tf module
     .ParseParamsByOperatorFn(AutoMappingByOpFn);
+
+// 三个参数的tf.where在图里就是Select/SelectV2，tf的Where算子只有condition一个输入，不在这里映射
+REGISTER_CUSTOM_OP("SelectV2")
+    .FrameworkType(TENSORFLOW)
+    .OriginOpType("Select")
+    .ParseParamsByOperatorFn(ParseParamsSelect);
 }  // namespace domi
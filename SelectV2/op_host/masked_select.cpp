@@ -0,0 +1,173 @@
+#include "masked_select_tiling.h"
+#include "register/op_def_registry.h"
+#include "tiling/platform/platform_ascendc.h"
+#include "graph/utils/type_utils.h"
+
+namespace optiling {
+const uint32_t BLOCK_SIZE = 32;         // block字节数，常量
+const uint32_t BUFFER_NUM = 2;          // double buffer，常量
+const uint32_t COMPARE_ALIGN_BLOCK = 8; // CompareScalar按256B对齐，即8个block
+const uint32_t COUNT_SLOT_SIZE = 64;    // 每个核在workspace里存计数的字节数，独占一个cache line
+static ge::graphStatus TilingFunc(gert::TilingContext* context)
+{
+    MaskedSelectTilingData tiling;
+    auto ascendcPlatform = platform_ascendc::PlatformAscendC(context->GetPlatformInfo());
+
+    // 1. condition和x必须同shape，不做广播
+    auto condShapeSize = context->GetInputShape(0)->GetOriginShape().GetShapeSize();
+    auto xShapeSize = context->GetInputShape(1)->GetOriginShape().GetShapeSize();
+    if (condShapeSize != xShapeSize) {
+        return ge::GRAPH_FAILED;
+    }
+    uint32_t totalDataNum = static_cast<uint32_t>(xShapeSize);
+
+    // 2. 输出下标时y必须是int32，输出元素时y必须和x同类型
+    const bool* emitIndicesAttr = context->GetAttrs()->GetAttrPointer<bool>(0);
+    uint8_t emitIndices = (emitIndicesAttr != nullptr && *emitIndicesAttr) ? 1 : 0;
+    auto xDataType = context->GetInputDesc(1)->GetDataType();
+    auto yDataType = context->GetOutputDesc(0)->GetDataType();
+    if (emitIndices ? (yDataType != ge::DataType::DT_INT32) : (yDataType != xDataType)) {
+        return ge::GRAPH_FAILED;
+    }
+
+    uint64_t ubSize;
+    ascendcPlatform.GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
+    uint32_t coreNum = ascendcPlatform.GetCoreNumAiv();
+
+    uint32_t xTypeLength = 0, yTypeLength = 0;
+    ge::TypeUtils::GetDataTypeLength(xDataType, xTypeLength);
+    ge::TypeUtils::GetDataTypeLength(yDataType, yTypeLength);
+
+    // 3. 每个元素在UB里占用的字节数
+    // 队列：condition、y，输出元素时还有x；临时：condition转half、selMask、计数用的GatherMask目的地址
+    uint32_t ubDataBytes = BUFFER_NUM * (1 + yTypeLength) + sizeof(uint16_t) + 1 + sizeof(uint16_t);
+    if (emitIndices) {
+        ubDataBytes += sizeof(int32_t); // 下标序列
+    } else {
+        ubDataBytes += BUFFER_NUM * xTypeLength;
+        switch (xDataType) {
+            case ge::DataType::DT_FLOAT16:
+            case ge::DataType::DT_FLOAT:
+            case ge::DataType::DT_INT32:
+                break;
+            case ge::DataType::DT_INT8:
+                ubDataBytes += 2 * sizeof(uint16_t); // GatherMask不支持1字节，x和y都要转成half
+                break;
+            default:
+                return ge::GRAPH_FAILED;
+        }
+    }
+
+    // 4. 一个tile里能放几个condition block，按CompareScalar的对齐要求向下取整
+    uint32_t tileCondBlockNum = ubSize / BLOCK_SIZE / ubDataBytes;
+    tileCondBlockNum = tileCondBlockNum / COMPARE_ALIGN_BLOCK * COMPARE_ALIGN_BLOCK;
+    uint32_t tileDataNum = tileCondBlockNum * BLOCK_SIZE;
+
+    // 5. 多核切分，按condition block均分，余下的block分给前tailBlockNum个大核
+    uint32_t condBlockNum = (totalDataNum + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    coreNum = condBlockNum < coreNum ? condBlockNum : coreNum;
+    coreNum = coreNum == 0 ? 1 : coreNum; // 空tensor也要起一个核写count
+    uint32_t everyCoreInputBlockNum = condBlockNum / coreNum;
+    uint32_t tailBlockNum = condBlockNum % coreNum;
+
+    uint32_t smallCoreDataNum = everyCoreInputBlockNum * BLOCK_SIZE;
+    uint32_t smallTileNum = everyCoreInputBlockNum / tileCondBlockNum;
+    uint32_t finalSmallTileNum = (everyCoreInputBlockNum % tileCondBlockNum == 0) ? smallTileNum : smallTileNum + 1;
+    uint32_t smallTailDataNum = smallCoreDataNum - (tileDataNum * smallTileNum);
+    smallTailDataNum = smallTailDataNum == 0 ? tileDataNum : smallTailDataNum;
+
+    everyCoreInputBlockNum += 1;
+    uint32_t bigCoreDataNum = everyCoreInputBlockNum * BLOCK_SIZE;
+    uint32_t bigTileNum = everyCoreInputBlockNum / tileCondBlockNum;
+    uint32_t finalBigTileNum = (everyCoreInputBlockNum % tileCondBlockNum == 0) ? bigTileNum : bigTileNum + 1;
+    uint32_t bigTailDataNum = bigCoreDataNum - (tileDataNum * bigTileNum);
+    bigTailDataNum = bigTailDataNum == 0 ? tileDataNum : bigTailDataNum;
+
+    /// 塞进tiling结构体
+    tiling.set_bigCoreDataNum(bigCoreDataNum);
+    tiling.set_smallCoreDataNum(smallCoreDataNum);
+    tiling.set_finalBigTileNum(finalBigTileNum);
+    tiling.set_finalSmallTileNum(finalSmallTileNum);
+    tiling.set_tileDataNum(tileDataNum);
+    tiling.set_bigTailDataNum(bigTailDataNum);
+    tiling.set_smallTailDataNum(smallTailDataNum);
+    tiling.set_tailBlockNum(tailBlockNum);
+    tiling.set_totalDataNum(totalDataNum);
+    tiling.set_emitIndices(emitIndices);
+
+    /// workspace: 系统workspace（SyncAll用）+ 每个核一个计数槽，用于核间前缀和
+    context->SetBlockDim(coreNum);
+    tiling.SaveToBuffer(context->GetRawTilingData()->GetData(), context->GetRawTilingData()->GetCapacity());
+    context->GetRawTilingData()->SetDataSize(tiling.GetDataSize());
+    size_t *currentWorkspace = context->GetWorkspaceSizes(1);
+    currentWorkspace[0] = ascendcPlatform.GetLibApiWorkSpaceSize() + coreNum * COUNT_SLOT_SIZE;
+    return ge::GRAPH_SUCCESS;
+}
+}
+
+
+namespace ge {
+static ge::graphStatus InferShape(gert::InferShapeContext* context)
+{
+    // y按最坏情况（全部选中）分配成一维，真实长度由count给出
+    const gert::Shape* xShape = context->GetInputShape(1);
+    gert::Shape* yShape = context->GetOutputShape(0);
+    gert::Shape* countShape = context->GetOutputShape(1);
+    yShape->SetDimNum(1);
+    yShape->SetDim(0, xShape->GetShapeSize());
+    countShape->SetDimNum(1);
+    countShape->SetDim(0, 1);
+    return GRAPH_SUCCESS;
+}
+
+static ge::graphStatus InferDataType(gert::InferDataTypeContext* context)
+{
+    const bool* emitIndices = context->GetAttrs()->GetAttrPointer<bool>(0);
+    bool isIndices = emitIndices != nullptr && *emitIndices;
+    context->SetOutputDataType(0, isIndices ? ge::DT_INT32 : context->GetInputDataType(1));
+    context->SetOutputDataType(1, ge::DT_INT32);
+    return GRAPH_SUCCESS;
+}
+}
+
+
+namespace ops {
+class MaskedSelect : public OpDef {
+public:
+    explicit MaskedSelect(const char* name) : OpDef(name)
+    {
+        this->Input("condition")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Input("x")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT8})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Output("y")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_INT32, ge::DT_INT32, ge::DT_INT32})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Output("count")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_INT32, ge::DT_INT32, ge::DT_INT32, ge::DT_INT32, ge::DT_INT32, ge::DT_INT32, ge::DT_INT32})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Attr("emit_indices").AttrType(OPTIONAL).Bool(false);
+
+        this->SetInferShape(ge::InferShape).SetInferDataType(ge::InferDataType);
+
+        this->AICore()
+            .SetTiling(optiling::TilingFunc);
+        // 核间前缀和用不带参数的硬件SyncAll，只有ascend910b支持；输出不对齐的片段用DataCopyPad写回，ascend910上也没有
+        this->AICore()
+            .AddConfig("ascend910b");
+
+    }
+};
+
+OP_ADD(MaskedSelect);
+}
@@ -0,0 +1,21 @@
+#include "register/tilingdata_base.h"
+#include "graph/utils/type_utils.h"
+
+namespace optiling {
+BEGIN_TILING_DATA_DEF(MaskedSelectTilingData)
+    TILING_DATA_FIELD_DEF(uint32_t, bigCoreDataNum);      // 大核处理的总数据数量（个）
+    TILING_DATA_FIELD_DEF(uint32_t, smallCoreDataNum);    // 小核处理的总数据数量（个）
+    TILING_DATA_FIELD_DEF(uint32_t, finalBigTileNum);     // 大核上数据搬运的次数
+    TILING_DATA_FIELD_DEF(uint32_t, finalSmallTileNum);   // 小核上数据搬运的次数
+    TILING_DATA_FIELD_DEF(uint32_t, tileDataNum);         // 单核单次搬运可处理的数据数量
+    TILING_DATA_FIELD_DEF(uint32_t, bigTailDataNum);      // 大核最后一次搬运可处理的数据数量
+    TILING_DATA_FIELD_DEF(uint32_t, smallTailDataNum);    // 小核最后一次搬运可处理的数据数量
+    TILING_DATA_FIELD_DEF(uint32_t, tailBlockNum);        // 大核的个数
+    TILING_DATA_FIELD_DEF(uint32_t, totalDataNum);        // 真实的元素个数，用于剔除32对齐补出来的数据
+
+    // 为1时输出被选中元素的扁平下标（tf.where(cond)），为0时输出被选中的元素（boolean_mask）
+    TILING_DATA_FIELD_DEF(uint8_t, emitIndices);
+END_TILING_DATA_DEF;
+
+REGISTER_TILING_DATA_CLASS(MaskedSelect, MaskedSelectTilingData)
+}
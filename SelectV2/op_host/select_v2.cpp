@@ -1,143 +1,138 @@
 #include "select_v2_tiling.h"
+#include "select_v2_tiling_calc.h"
+#include "select_v2_tiling_report.h"
 #include "register/op_def_registry.h"
 #include "tiling/platform/platform_ascendc.h"
 #include "graph/utils/type_utils.h"
+#include "toolchain/slog.h"
 
 namespace optiling {
-const uint32_t BLOCK_SIZE = 32; // block字节数，常量
-const uint32_t BUFFER_NUM = 2;	// double buffer，常量
+static TilingShape ToTilingShape(const gert::Shape& shape)
+{
+    TilingShape tilingShape;
+    for (size_t i = 0; i < shape.GetDimNum(); i++) {
+        tilingShape.dims.push_back(shape.GetDim(i));
+    }
+    return tilingShape;
+}
+
+static SelectV2DataType ToSelectV2DataType(ge::DataType dataType)
+{
+    switch (dataType) {
+        case ge::DataType::DT_FLOAT16:
+            return SelectV2DataType::FLOAT16;
+        case ge::DataType::DT_FLOAT:
+            return SelectV2DataType::FLOAT;
+        case ge::DataType::DT_INT8:
+            return SelectV2DataType::INT8;
+        case ge::DataType::DT_INT32:
+            return SelectV2DataType::INT32;
+        default:
+            return SelectV2DataType::OTHER;
+    }
+}
+
+// 没有带宽模型的SoC返回nullptr，调试输出里不给估算
+static const char* GetSocName(platform_ascendc::SocVersion socVersion)
+{
+    switch (socVersion) {
+        case platform_ascendc::SocVersion::ASCEND910:
+            return "ascend910";
+        case platform_ascendc::SocVersion::ASCEND910B:
+            return "ascend910b";
+        case platform_ascendc::SocVersion::ASCEND310P:
+            return "ascend310p";
+        case platform_ascendc::SocVersion::ASCEND310B:
+            return "ascend310b";
+        default:
+            return nullptr;
+    }
+}
+
 static ge::graphStatus TilingFunc(gert::TilingContext* context)
 {
-    SelectV2TilingData tiling;
     auto ascendcPlatform = platform_ascendc::PlatformAscendC(context->GetPlatformInfo());
     
-    /// 广播相关tiling    
-    // 1. 获取输入输出shape
-    auto condShape = context->GetInputShape(0)->GetOriginShape();
-    auto x1Shape = context->GetInputShape(1)->GetOriginShape();
-    auto x2Shape = context->GetInputShape(2)->GetOriginShape();
-    auto yShape = context->GetOutputShape(0)->GetOriginShape();
-    auto condShapeSize = condShape.GetShapeSize();
-    auto x1ShapeSize = x1Shape.GetShapeSize();
-    auto x2ShapeSize = x2Shape.GetShapeSize();
-    auto yShapeSize = yShape.GetShapeSize();
-    
-    // 判断是否需要广播
-    uint8_t condNeedBroadcast = condShapeSize != yShapeSize;
-    uint8_t x1NeedBroadcast = x1ShapeSize != yShapeSize;
-    uint8_t x2NeedBroadcast = x2ShapeSize != yShapeSize;
-    uint8_t needBroadcast = condNeedBroadcast || x1NeedBroadcast || x2NeedBroadcast;
-    tiling.set_needBroadcast(needBroadcast);
-    if (needBroadcast) {
-        uint8_t yDimNum = static_cast<uint8_t>(yShape.GetDimNum());
-        uint8_t condDimNum = static_cast<uint8_t>(condShape.GetDimNum());
-        uint8_t x1DimNum = static_cast<uint8_t>(x1Shape.GetDimNum());
-        uint8_t x2DimNum = static_cast<uint8_t>(x2Shape.GetDimNum());
-        if (yDimNum > 8 || condDimNum > 8 || x1DimNum > 8 || x2DimNum > 8) {
-            return ge::GRAPH_FAILED;
-        }
-        uint16_t condShapeVec[8] {};
-        uint16_t x1ShapeVec[8] {};
-        uint16_t x2ShapeVec[8] {};
-        uint16_t yShapeVec[8] {};
-        for (int32_t i = 0; i < yDimNum; i++) {
-            yShapeVec[i] = static_cast<uint16_t>(yShape.GetDim(yDimNum - 1 - i));
-            condShapeVec[i] = condDimNum - 1 - i >= 0 ? static_cast<uint16_t>(condShape.GetDim(condDimNum - 1 - i)) : 1;
-            x1ShapeVec[i] = x1DimNum - 1 - i >= 0 ? static_cast<uint16_t>(x1Shape.GetDim(x1DimNum - 1 - i)) : 1;
-            x2ShapeVec[i] = x2DimNum - 1 - i >= 0 ? static_cast<uint16_t>(x2Shape.GetDim(x2DimNum - 1 - i)) : 1;
-        }
-        
-        // 2. 获取输入输出strides
-        uint32_t condStrides[8] {};
-        uint32_t x1Strides[8] {};
-        uint32_t x2Strides[8] {};
-        uint32_t yStrides[8] {};
-        
-        uint32_t y_stride = 1, cond_stride = 1, x1_stride = 1, x2_stride = 1;
-        for (size_t i = 0; i < yDimNum; i++) {
-            if (yShapeVec[i] != 1) {
-                yStrides[i] = y_stride;
-                y_stride *= yShapeVec[i];
-            }
-            if (condShapeVec[i] != 1) {
-                condStrides[i] = cond_stride;
-                cond_stride *= condShapeVec[i];
-            }
-            if (x1ShapeVec[i] != 1) {
-                x1Strides[i] = x1_stride;
-                x1_stride *= x1ShapeVec[i];
-            }
-            if (x2ShapeVec[i] != 1) {
-                x2Strides[i] = x2_stride;
-                x2_stride *= x2ShapeVec[i];
-            }
-        }
-        
-        // 3. 塞进tiling结构体
-        tiling.set_yDimNum(yDimNum);
-        tiling.set_yShape(yShapeVec);
-        tiling.set_condStrides(condStrides);
-        tiling.set_x1Strides(x1Strides);
-        tiling.set_x2Strides(x2Strides);
-        tiling.set_yStrides(yStrides);
-        tiling.set_condNeedBroadcast(condNeedBroadcast);
-        tiling.set_x1NeedBroadcast(x1NeedBroadcast);
-        tiling.set_x2NeedBroadcast(x2NeedBroadcast);
+    // 1. 从context取出shape、类型和属性，tiling计算本身在select_v2_tiling_calc.h里
+    SelectV2TilingInput input;
+    input.condShape = ToTilingShape(context->GetInputShape(0)->GetOriginShape());
+    input.x1Shape = ToTilingShape(context->GetInputShape(1)->GetOriginShape());
+    input.x2Shape = ToTilingShape(context->GetInputShape(2)->GetOriginShape());
+    input.yShape = ToTilingShape(context->GetOutputShape(0)->GetOriginShape());
+    auto biasInputShape = context->GetOptionalInputShape(3);
+    if (biasInputShape != nullptr) {
+        input.hasBias = true;
+        input.biasShape = ToTilingShape(biasInputShape->GetOriginShape());
+        input.biasDataType = ToSelectV2DataType(context->GetOptionalInputDesc(3)->GetDataType());
     }
+    input.x1DataType = ToSelectV2DataType(context->GetInputDesc(1)->GetDataType());
+    input.x2DataType = ToSelectV2DataType(context->GetInputDesc(2)->GetDataType());
+    input.yDataType = ToSelectV2DataType(context->GetOutputDesc(0)->GetDataType());
     
-    // 每个核一次计算最多能处理的字节数，从接口获取
-    uint64_t ubSize; 	
-    ascendcPlatform.GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
-    
-    // 获取输入数据数量, totalDataNum表示几个元素
-    uint32_t totalDataNum = context->GetOutputShape(0)->GetOriginShape().GetShapeSize();
+    auto attrs = context->GetAttrs();
+    const float* scaleAttr = attrs->GetAttrPointer<float>(1);
+    const float* addScalarAttr = attrs->GetAttrPointer<float>(2);
+    const bool* rowSelectAttr = attrs->GetAttrPointer<bool>(4);
+    input.epilogueScale = scaleAttr != nullptr ? *scaleAttr : 1.0f;
+    input.epilogueAddScalar = addScalarAttr != nullptr ? *addScalarAttr : 0.0f;
+    input.epilogueActivation = attrs->GetAttrPointer<char>(3);
+    input.rowSelect = rowSelectAttr != nullptr && *rowSelectAttr;
     
-    // typeLength表示输入的数据类型占几个字节，inputLength表示输入数据的总字节
-    uint32_t condTypeLength = 0, x1TypeLength = 0;
-    ge::TypeUtils::GetDataTypeLength(context->GetInputDesc(0)->GetDataType(), condTypeLength);
-    ge::TypeUtils::GetDataTypeLength(context->GetInputDesc(1)->GetDataType(), x1TypeLength);
-    uint32_t r = x1TypeLength / condTypeLength; // 一定能整除，因为condTypeLength=1B
-            
-    // 总共有几个 cond 块
-    uint32_t condBlockNum = (totalDataNum + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    // 每个核一次计算最多能处理的字节数，从接口获取
+    ascendcPlatform.GetCoreMemSize(platform_ascendc::CoreMemType::UB, input.ubSize);
     
-    /// 计算每个tile内的参数
-    // 1. tileCondBlockNum 一个tile里可以存几个 condBlock
-    uint32_t rate = 3 * r + 1;
-    auto x1DataType = context->GetInputDesc(1)->GetDataType();
-    switch (x1DataType) {
-        case ge::DataType::DT_FLOAT16:
-            rate += 3;
-            break;
-        case ge::DataType::DT_INT8:
-            rate += 9;
-            break;
-        case ge::DataType::DT_INT32:
-            rate += 9;
-            break;
-        case ge::DataType::DT_FLOAT:
-            rate += 3;
-            break;
-        default:
-            return ge::GRAPH_FAILED;
+    SelectV2TilingParam param;
+    if (!CalcSelectV2Tiling(input, param)) {
+        return ge::GRAPH_FAILED;
     }
     
-    uint32_t tileCondBlockNum = ubSize / BUFFER_NUM / BLOCK_SIZE / rate;
-    // 3. 一个tile里的数据数量
-    uint32_t tileDataNum = BLOCK_SIZE * tileCondBlockNum / condTypeLength;
+    // 排查慢shape时把日志级别调到debug，选中的路径和完整的tiling按行写进plog
+    if (CheckLogLevel(OP, DLOG_DEBUG) == 1) {
+        const char* socName = GetSocName(ascendcPlatform.GetSocVersion());
+        const SelectV2SocModel* model = socName != nullptr ? FindSelectV2SocModel(socName) : nullptr;
+        std::string report = FormatSelectV2Tiling(input, param, model);
+        size_t start = 0;
+        while (start < report.size()) {
+            size_t end = report.find('\n', start);
+            end = end == std::string::npos ? report.size() : end;
+            dlog_debug(OP, "[SelectV2] %s", report.substr(start, end - start).c_str());
+            start = end + 1;
+        }
+    }
     
-    uint32_t smallDataNum = condBlockNum * BLOCK_SIZE / condTypeLength;
-    uint32_t smallTileNum = condBlockNum / tileCondBlockNum;
-    uint32_t finalSmallTileNum = (condBlockNum % tileCondBlockNum == 0) ? smallTileNum : smallTileNum + 1;
-    uint32_t smallTailDataNum = smallDataNum - (tileDataNum * smallTileNum);
-    smallTailDataNum = smallTailDataNum == 0? tileDataNum : smallTailDataNum;
-         
-
-    /// 塞进tiling结构体
-    tiling.set_smallDataNum(smallDataNum);
-    tiling.set_finalSmallTileNum(finalSmallTileNum);
-    tiling.set_tileDataNum(tileDataNum);
-    tiling.set_smallTailDataNum(smallTailDataNum);
+    /// 2. 塞进tiling结构体
+    SelectV2TilingData tiling;
+    tiling.set_smallDataNum(param.smallDataNum);
+    tiling.set_finalSmallTileNum(param.finalSmallTileNum);
+    tiling.set_tileDataNum(param.tileDataNum);
+    tiling.set_smallTailDataNum(param.smallTailDataNum);
+    tiling.set_needBroadcast(param.needBroadcast);
+    tiling.set_yShape(param.yShape);
+    tiling.set_yDimNum(param.yDimNum);
+    tiling.set_condStrides(param.condStrides);
+    tiling.set_x1Strides(param.x1Strides);
+    tiling.set_x2Strides(param.x2Strides);
+    tiling.set_yStrides(param.yStrides);
+    tiling.set_condNeedBroadcast(param.condNeedBroadcast);
+    tiling.set_x1NeedBroadcast(param.x1NeedBroadcast);
+    tiling.set_x2NeedBroadcast(param.x2NeedBroadcast);
+    tiling.set_epilogueFlags(param.epilogueFlags);
+    tiling.set_epilogueScale(param.epilogueScale);
+    tiling.set_epilogueAddScalar(param.epilogueAddScalar);
+    tiling.set_biasNeedBroadcast(param.biasNeedBroadcast);
+    tiling.set_biasStrides(param.biasStrides);
+    tiling.set_tinyTensor(param.tinyTensor);
+    tiling.set_tileReuse(param.tileReuse);
+    tiling.set_outerNum(param.outerNum);
+    tiling.set_innerNum(param.innerNum);
+    tiling.set_tileRowNum(param.tileRowNum);
+    tiling.set_tileColNum(param.tileColNum);
+    tiling.set_condMode(param.condMode);
+    tiling.set_x1Mode(param.x1Mode);
+    tiling.set_x2Mode(param.x2Mode);
+    tiling.set_rowCopy(param.rowCopy);
+    tiling.set_rowNum(param.rowNum);
+    tiling.set_rowDataNum(param.rowDataNum);
 
     /// workspace
     context->SetBlockDim(1);
@@ -150,6 +145,22 @@ static ge::graphStatus TilingFunc(gert::TilingContext* context)
 }
 
 
+namespace ge {
+static ge::graphStatus InferDataType(gert::InferDataTypeContext* context)
+{
+    const int64_t* dstType = context->GetAttrs()->GetAttrPointer<int64_t>(0);
+    if (dstType != nullptr && *dstType >= 0) {
+        context->SetOutputDataType(0, static_cast<ge::DataType>(*dstType));
+        return GRAPH_SUCCESS;
+    }
+    auto x1DataType = context->GetInputDataType(1);
+    auto x2DataType = context->GetInputDataType(2);
+    context->SetOutputDataType(0, x1DataType == x2DataType ? x1DataType : ge::DT_FLOAT);
+    return GRAPH_SUCCESS;
+}
+}
+
+
 namespace ops {
 class SelectV2 : public OpDef {
 public:
@@ -157,24 +168,39 @@ public:
     {
         this->Input("condition")
             .ParamType(REQUIRED)
-            .DataType({ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL})
-            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
-            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+            .DataType({ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL, ge::DT_BOOL})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
         this->Input("x1")
             .ParamType(REQUIRED)
-            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8})
-            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
-            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_FLOAT16, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_FLOAT, ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
         this->Input("x2")
             .ParamType(REQUIRED)
-            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8})
-            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
-            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Input("bias")
+            .ParamType(OPTIONAL)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_FLOAT, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_FLOAT16, ge::DT_FLOAT16, ge::DT_FLOAT})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
         this->Output("y")
             .ParamType(REQUIRED)
-            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8})
-            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
-            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_INT32, ge::DT_INT8, ge::DT_FLOAT, ge::DT_FLOAT, ge::DT_FLOAT16, ge::DT_FLOAT16, ge::DT_FLOAT16, ge::DT_FLOAT})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND, ge::FORMAT_ND});
+        // y默认取x1/x2提升后的类型，dst_type>=0时按指定类型输出
+        this->Attr("dst_type").AttrType(OPTIONAL).Int(-1);
+        // 融合尾处理：y = act(y * epilogue_scale + epilogue_add + bias)，act可选 none/exp/relu
+        this->Attr("epilogue_scale").AttrType(OPTIONAL).Float(1.0);
+        this->Attr("epilogue_add").AttrType(OPTIONAL).Float(0.0);
+        this->Attr("epilogue_activation").AttrType(OPTIONAL).String("none");
+        // tf Select语义：condition为1维时对齐x的第0维按行选择
+        this->Attr("row_select").AttrType(OPTIONAL).Bool(false);
+
+        this->SetInferDataType(ge::InferDataType);
 
         this->AICore()
             .SetTiling(optiling::TilingFunc);
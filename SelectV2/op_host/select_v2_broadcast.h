@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+
+namespace optiling {
+const uint8_t MAX_BROADCAST_DIM = 8; // 广播最多支持的维度数
+
+// y的shape按从低维到高维的顺序存放；ShapeT只需要GetDimNum/GetDim，gert::Shape和dry-run工具里的shape都能用
+template <typename ShapeT>
+inline void GetBroadcastShape(const ShapeT& yShape, uint16_t yShapeVec[MAX_BROADCAST_DIM])
+{
+    uint8_t yDimNum = static_cast<uint8_t>(yShape.GetDimNum());
+    for (int32_t i = 0; i < yDimNum; i++) {
+        yShapeVec[i] = static_cast<uint16_t>(yShape.GetDim(yDimNum - 1 - i));
+    }
+}
+
+// 把输入shape右对齐到y上，计算输入在y每一维上的stride，长度为1的维（广播维）stride为0
+template <typename ShapeT>
+inline void GetBroadcastStrides(const ShapeT& shape, uint8_t yDimNum, uint32_t strides[MAX_BROADCAST_DIM])
+{
+    uint8_t dimNum = static_cast<uint8_t>(shape.GetDimNum());
+    uint32_t stride = 1;
+    for (int32_t i = 0; i < yDimNum; i++) {
+        uint16_t dim = dimNum - 1 - i >= 0 ? static_cast<uint16_t>(shape.GetDim(dimNum - 1 - i)) : 1;
+        if (dim != 1) {
+            strides[i] = stride;
+            stride *= dim;
+        }
+    }
+}
+
+// 外轴/内轴广播时输入的四种形态，和kernel里的定义一致
+const uint8_t OPERAND_FULL = 0;   // 和y同shape
+const uint8_t OPERAND_ROW = 1;    // 外轴全部广播，如[1,S]
+const uint8_t OPERAND_COL = 2;    // 内轴全部广播，如[N,1]
+const uint8_t OPERAND_SCALAR = 3; // 全部广播
+const uint8_t OPERAND_OTHER = 0xff;
+
+// 以splitDim为界，低维是内轴、高维是外轴，y上长度为1的维不影响判断
+inline uint8_t GetOperandMode(const uint16_t yShapeVec[MAX_BROADCAST_DIM], const uint32_t strides[MAX_BROADCAST_DIM],
+                              uint8_t yDimNum, uint8_t splitDim)
+{
+    bool innerKept = true, innerBroadcast = true, outerKept = true, outerBroadcast = true;
+    for (uint8_t i = 0; i < yDimNum; i++) {
+        if (yShapeVec[i] == 1) {
+            continue;
+        }
+        bool kept = strides[i] != 0;
+        if (i < splitDim) {
+            innerKept = innerKept && kept;
+            innerBroadcast = innerBroadcast && !kept;
+        } else {
+            outerKept = outerKept && kept;
+            outerBroadcast = outerBroadcast && !kept;
+        }
+    }
+    if (innerKept && outerKept) {
+        return OPERAND_FULL;
+    } else if (innerKept && outerBroadcast) {
+        return OPERAND_ROW;
+    } else if (innerBroadcast && outerKept) {
+        return OPERAND_COL;
+    } else if (innerBroadcast && outerBroadcast) {
+        return OPERAND_SCALAR;
+    }
+    return OPERAND_OTHER;
+}
+}
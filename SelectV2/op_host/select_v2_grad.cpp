@@ -0,0 +1,252 @@
+#include "select_v2_grad_tiling.h"
+#include "select_v2_grad_tiling_calc.h"
+#include "select_v2_broadcast.h"
+#include "register/op_def_registry.h"
+#include "tiling/platform/platform_ascendc.h"
+#include "graph/utils/type_utils.h"
+
+namespace optiling {
+const uint32_t MAX_FOLD_COL_NUM = 2040; // 一个tile放多行时按行求和用repeat stride跨行，stride是uint8，一行最多255个block的float
+const uint32_t RESERVED_UB_BYTES = 1024; // 标量累加区等不随tile变化的小块UB
+
+static ge::graphStatus TilingFunc(gert::TilingContext* context)
+{
+    SelectV2GradTilingData tiling;
+    auto ascendcPlatform = platform_ascendc::PlatformAscendC(context->GetPlatformInfo());
+
+    /// 广播相关tiling，和SelectV2前向一致，只是dx1/dx2的广播在反向里变成规约
+    // 1. 获取输入输出shape，x1/x2只用来提供shape
+    auto condShape = context->GetInputShape(0)->GetOriginShape();
+    auto x1Shape = context->GetInputShape(1)->GetOriginShape();
+    auto x2Shape = context->GetInputShape(2)->GetOriginShape();
+    auto yShape = context->GetInputShape(3)->GetOriginShape();
+    auto condShapeSize = condShape.GetShapeSize();
+    auto x1ShapeSize = x1Shape.GetShapeSize();
+    auto x2ShapeSize = x2Shape.GetShapeSize();
+    auto yShapeSize = yShape.GetShapeSize();
+
+    uint8_t condNeedBroadcast = condShapeSize != yShapeSize;
+    uint8_t x1NeedReduce = x1ShapeSize != yShapeSize;
+    uint8_t x2NeedReduce = x2ShapeSize != yShapeSize;
+    tiling.set_condNeedBroadcast(condNeedBroadcast);
+    tiling.set_x1NeedReduce(x1NeedReduce);
+    tiling.set_x2NeedReduce(x2NeedReduce);
+    uint32_t dx1DataNum = static_cast<uint32_t>(x1ShapeSize);
+    uint32_t dx2DataNum = static_cast<uint32_t>(x2ShapeSize);
+    tiling.set_dx1DataNum(dx1DataNum);
+    tiling.set_dx2DataNum(dx2DataNum);
+
+    uint8_t tileReduce = 0;
+    uint32_t outerNum = 0;
+    uint32_t innerNum = 0;
+    uint8_t condMode = OPERAND_FULL;
+    uint8_t x1Mode = OPERAND_FULL;
+    uint8_t x2Mode = OPERAND_FULL;
+    if (condNeedBroadcast || x1NeedReduce || x2NeedReduce) {
+        uint8_t yDimNum = static_cast<uint8_t>(yShape.GetDimNum());
+        if (yDimNum > MAX_BROADCAST_DIM || condShape.GetDimNum() > MAX_BROADCAST_DIM ||
+            x1Shape.GetDimNum() > MAX_BROADCAST_DIM || x2Shape.GetDimNum() > MAX_BROADCAST_DIM) {
+            return ge::GRAPH_FAILED;
+        }
+        uint16_t yShapeVec[MAX_BROADCAST_DIM] {};
+        uint32_t condStrides[MAX_BROADCAST_DIM] {};
+        uint32_t x1Strides[MAX_BROADCAST_DIM] {};
+        uint32_t x2Strides[MAX_BROADCAST_DIM] {};
+        uint32_t yStrides[MAX_BROADCAST_DIM] {};
+        GetBroadcastShape(yShape, yShapeVec);
+        GetBroadcastStrides(yShape, yDimNum, yStrides);
+        GetBroadcastStrides(condShape, yDimNum, condStrides);
+        GetBroadcastStrides(x1Shape, yDimNum, x1Strides);
+        GetBroadcastStrides(x2Shape, yDimNum, x2Strides);
+
+        tiling.set_yDimNum(yDimNum);
+        tiling.set_yShape(yShapeVec);
+        tiling.set_condStrides(condStrides);
+        tiling.set_x1Strides(x1Strides);
+        tiling.set_x2Strides(x2Strides);
+        tiling.set_yStrides(yStrides);
+
+        // 2. 外轴/内轴广播：找一个切分维，让cond、dx1、dx2都是完整、整行、整列或标量之一，规约就能按行/按列用向量指令完成
+        // 切分维可以取最高维，这时外轴长度为1，整体广播的输入按COL处理；内轴按32个元素对齐，condition每行都能整块搬运
+        for (int32_t splitDim = yDimNum; splitDim > 0; splitDim--) {
+            uint32_t splitInnerNum = 1, splitOuterNum = 1;
+            for (int32_t i = 0; i < yDimNum; i++) {
+                if (i < splitDim) {
+                    splitInnerNum *= yShapeVec[i];
+                } else {
+                    splitOuterNum *= yShapeVec[i];
+                }
+            }
+            uint8_t splitCondMode = GetOperandMode(yShapeVec, condStrides, yDimNum, splitDim);
+            uint8_t splitX1Mode = GetOperandMode(yShapeVec, x1Strides, yDimNum, splitDim);
+            uint8_t splitX2Mode = GetOperandMode(yShapeVec, x2Strides, yDimNum, splitDim);
+            if (splitInnerNum % BLOCK_SIZE != 0 || splitCondMode == OPERAND_OTHER ||
+                splitX1Mode == OPERAND_OTHER || splitX2Mode == OPERAND_OTHER) {
+                continue;
+            }
+            tileReduce = 1;
+            outerNum = splitOuterNum;
+            innerNum = splitInnerNum;
+            condMode = splitCondMode;
+            x1Mode = splitX1Mode;
+            x2Mode = splitX2Mode;
+            break;
+        }
+    }
+
+    uint64_t ubSize;
+    ascendcPlatform.GetCoreMemSize(platform_ascendc::CoreMemType::UB, ubSize);
+
+    uint32_t totalDataNum = static_cast<uint32_t>(yShapeSize);
+    uint32_t dyTypeLength = 0;
+    auto dyDataType = context->GetInputDesc(3)->GetDataType();
+    ge::TypeUtils::GetDataTypeLength(dyDataType, dyTypeLength);
+    if (dyDataType != ge::DataType::DT_FLOAT16 && dyDataType != ge::DataType::DT_FLOAT) {
+        return ge::GRAPH_FAILED;
+    }
+    uint32_t halfSelBytes = dyDataType == ge::DataType::DT_FLOAT16 ? dyTypeLength : 0;
+
+    uint32_t accBytes = 0;
+    uint8_t accInWorkspace = 0;
+    uint32_t ubDataBytes = 0;
+    if (tileReduce) {
+        // 3. 每个元素在UB里占用的字节数
+        // 队列：condition、dy、dx1、dx2（规约时用来写回结果）；临时：condition转half、selMask、全0的tile
+        // 规约时还有float的选中tile（half时先选到一块half的tile再转float），按行累加的累加区，按列求和的结果
+        ubDataBytes = BUFFER_NUM * (1 + dyTypeLength) + sizeof(uint16_t) + 1 + dyTypeLength + 2 * BUFFER_NUM * dyTypeLength;
+        ubDataBytes += (x1Mode != OPERAND_FULL || x2Mode != OPERAND_FULL) ? sizeof(float) + halfSelBytes : 0;
+        ubDataBytes += x1Mode == OPERAND_ROW ? sizeof(float) : 0;
+        ubDataBytes += x2Mode == OPERAND_ROW ? sizeof(float) : 0;
+        ubDataBytes += (x1Mode == OPERAND_COL || x1Mode == OPERAND_SCALAR ||
+                        x2Mode == OPERAND_COL || x2Mode == OPERAND_SCALAR) ? 1 : 0;
+        accBytes = RESERVED_UB_BYTES;
+    } else {
+        // 3. 逐元素路径的累加区和每个元素的UB占用，见select_v2_grad_tiling_calc.h
+        SelectV2GradFallbackPlan plan = PlanSelectV2GradFallback(ubSize, dyTypeLength, x1NeedReduce, x2NeedReduce,
+                                                                 dx1DataNum, dx2DataNum);
+        accInWorkspace = plan.accInWorkspace;
+        accBytes = plan.accBytes;
+        ubDataBytes = plan.ubDataBytes;
+    }
+
+    uint32_t tileDataNum = GetSelectV2GradTileDataNum(ubSize, accBytes, ubDataBytes);
+    if (tileDataNum == 0) {
+        return ge::GRAPH_FAILED;
+    }
+    uint32_t tileCondBlockNum = tileDataNum / BLOCK_SIZE;
+
+    uint32_t condBlockNum = (totalDataNum + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    uint32_t smallDataNum = condBlockNum * BLOCK_SIZE;
+    uint32_t smallTileNum = condBlockNum / tileCondBlockNum;
+    uint32_t finalSmallTileNum = (condBlockNum % tileCondBlockNum == 0) ? smallTileNum : smallTileNum + 1;
+    uint32_t smallTailDataNum = smallDataNum - (tileDataNum * smallTileNum);
+    smallTailDataNum = smallTailDataNum == 0 ? tileDataNum : smallTailDataNum;
+
+    // 5. 行短时一个tile放多行，行长时放一行的一段；按列求和时每行的float要在repeat stride的范围内
+    uint32_t tileRowNum = 0;
+    uint32_t tileColNum = 0;
+    size_t usrWorkspaceSize = 0;
+    if (tileReduce) {
+        bool colReduce = x1Mode == OPERAND_COL || x2Mode == OPERAND_COL;
+        tileColNum = innerNum <= tileDataNum ? innerNum : tileDataNum;
+        tileRowNum = (innerNum <= tileDataNum && !(colReduce && innerNum > MAX_FOLD_COL_NUM)) ? tileDataNum / innerNum : 1;
+        // 一行被切成多段时，按列求和的每段部分和先写到workspace，全部算完后再按行汇总
+        if (tileColNum < innerNum) {
+            uint32_t colChunkNum = (innerNum + tileColNum - 1) / tileColNum;
+            size_t partialBytes = static_cast<size_t>(colChunkNum) * AlignUp(outerNum, BLOCK_SIZE / sizeof(float)) * sizeof(float);
+            usrWorkspaceSize += x1Mode == OPERAND_COL ? partialBytes : 0;
+            usrWorkspaceSize += x2Mode == OPERAND_COL ? partialBytes : 0;
+        }
+    } else if (accInWorkspace) {
+        usrWorkspaceSize += x1NeedReduce ? AlignUp(dx1DataNum, BLOCK_SIZE / sizeof(float)) * sizeof(float) : 0;
+        usrWorkspaceSize += x2NeedReduce ? AlignUp(dx2DataNum, BLOCK_SIZE / sizeof(float)) * sizeof(float) : 0;
+    }
+
+    /// 塞进tiling结构体
+    tiling.set_smallDataNum(smallDataNum);
+    tiling.set_finalSmallTileNum(finalSmallTileNum);
+    tiling.set_tileDataNum(tileDataNum);
+    tiling.set_smallTailDataNum(smallTailDataNum);
+    tiling.set_totalDataNum(totalDataNum);
+    tiling.set_accInWorkspace(accInWorkspace);
+    tiling.set_tileReduce(tileReduce);
+    tiling.set_outerNum(outerNum);
+    tiling.set_innerNum(innerNum);
+    tiling.set_tileRowNum(tileRowNum);
+    tiling.set_tileColNum(tileColNum);
+    tiling.set_condMode(condMode);
+    tiling.set_x1Mode(x1Mode);
+    tiling.set_x2Mode(x2Mode);
+
+    /// workspace: 系统workspace + 规约用的float累加区
+    context->SetBlockDim(1);
+    tiling.SaveToBuffer(context->GetRawTilingData()->GetData(), context->GetRawTilingData()->GetCapacity());
+    context->GetRawTilingData()->SetDataSize(tiling.GetDataSize());
+    size_t *currentWorkspace = context->GetWorkspaceSizes(1);
+    currentWorkspace[0] = ascendcPlatform.GetLibApiWorkSpaceSize() + usrWorkspaceSize;
+    return ge::GRAPH_SUCCESS;
+}
+}
+
+
+namespace ge {
+static ge::graphStatus InferShape(gert::InferShapeContext* context)
+{
+    *context->GetOutputShape(0) = *context->GetInputShape(1);
+    *context->GetOutputShape(1) = *context->GetInputShape(2);
+    return GRAPH_SUCCESS;
+}
+}
+
+
+namespace ops {
+class SelectV2Grad : public OpDef {
+public:
+    explicit SelectV2Grad(const char* name) : OpDef(name)
+    {
+        this->Input("condition")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_BOOL, ge::DT_BOOL})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Input("x1")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Input("x2")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Input("dy")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Output("dx1")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+        this->Output("dx2")
+            .ParamType(REQUIRED)
+            .DataType({ge::DT_FLOAT, ge::DT_FLOAT16})
+            .Format({ge::FORMAT_ND, ge::FORMAT_ND})
+            .UnknownShapeFormat({ge::FORMAT_ND, ge::FORMAT_ND});
+
+        this->SetInferShape(ge::InferShape);
+
+        this->AICore()
+            .SetTiling(optiling::TilingFunc);
+        // 规约结果长度不一定32B对齐，写回用DataCopyPad，ascend910上没有这条指令
+        this->AICore()
+            .AddConfig("ascend310p")
+            .AddConfig("ascend310b")
+            .AddConfig("ascend910b");
+
+    }
+};
+
+OP_ADD(SelectV2Grad);
+}
@@ -0,0 +1,40 @@
+#include "register/tilingdata_base.h"
+#include "graph/utils/type_utils.h"
+
+namespace optiling {
+BEGIN_TILING_DATA_DEF(SelectV2GradTilingData)
+    TILING_DATA_FIELD_DEF(uint32_t, smallDataNum);      // 小核处理的总数据数量（个）
+    TILING_DATA_FIELD_DEF(uint32_t, finalSmallTileNum); // 小核上数据搬运的次数
+    TILING_DATA_FIELD_DEF(uint32_t, tileDataNum);       // 单核单次搬运可处理的数据数量
+    TILING_DATA_FIELD_DEF(uint32_t, smallTailDataNum);  // 小核最后一次搬运可处理的数据数量
+    TILING_DATA_FIELD_DEF(uint32_t, totalDataNum);      // dy真实的元素个数，累加时剔除32对齐补出来的数据
+
+    // 以下字段在condition广播或dx1/dx2需要规约时使用，含义同SelectV2TilingData
+    TILING_DATA_FIELD_DEF_ARR(uint16_t, 8, yShape);      // dy的shape
+    TILING_DATA_FIELD_DEF(uint8_t, yDimNum);             // dy的维度数量
+
+    TILING_DATA_FIELD_DEF_ARR(uint32_t, 8, condStrides); // cond的strides
+    TILING_DATA_FIELD_DEF_ARR(uint32_t, 8, x1Strides);   // dx1的strides
+    TILING_DATA_FIELD_DEF_ARR(uint32_t, 8, x2Strides);   // dx2的strides
+    TILING_DATA_FIELD_DEF_ARR(uint32_t, 8, yStrides);    // dy的strides
+
+    TILING_DATA_FIELD_DEF(uint8_t, condNeedBroadcast);
+    TILING_DATA_FIELD_DEF(uint8_t, x1NeedReduce);        // x1前向时被广播过，dx1要沿广播轴求和
+    TILING_DATA_FIELD_DEF(uint8_t, x2NeedReduce);        // x2前向时被广播过，dx2要沿广播轴求和
+    TILING_DATA_FIELD_DEF(uint32_t, dx1DataNum);         // dx1的元素个数
+    TILING_DATA_FIELD_DEF(uint32_t, dx2DataNum);         // dx2的元素个数
+    TILING_DATA_FIELD_DEF(uint8_t, accInWorkspace);      // 逐元素规约时累加区放不进UB，改在workspace里累加
+
+    // 外轴/内轴广播时按[outerNum, innerNum]分块，规约用向量指令完成，含义同SelectV2TilingData
+    TILING_DATA_FIELD_DEF(uint8_t, tileReduce);
+    TILING_DATA_FIELD_DEF(uint32_t, outerNum);           // dy的外轴长度（行数）
+    TILING_DATA_FIELD_DEF(uint32_t, innerNum);           // dy的内轴长度（列数）
+    TILING_DATA_FIELD_DEF(uint32_t, tileRowNum);         // 一个tile里的行数
+    TILING_DATA_FIELD_DEF(uint32_t, tileColNum);         // 一个tile里的列数
+    TILING_DATA_FIELD_DEF(uint8_t, condMode);            // cond的形态，OPERAND_*
+    TILING_DATA_FIELD_DEF(uint8_t, x1Mode);              // dx1的形态，ROW按行累加，COL每行求和，SCALAR全部求和
+    TILING_DATA_FIELD_DEF(uint8_t, x2Mode);              // dx2的形态
+END_TILING_DATA_DEF;
+
+REGISTER_TILING_DATA_CLASS(SelectV2Grad, SelectV2GradTilingData)
+}
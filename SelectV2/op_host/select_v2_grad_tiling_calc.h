@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+
+// SelectV2Grad逐元素路径（非tileReduce）的UB规划，不依赖CANN，TilingFunc和testcases共用
+namespace optiling {
+const uint32_t BLOCK_SIZE = 32;         // block字节数，常量
+const uint32_t BUFFER_NUM = 2;          // double buffer，常量
+const uint32_t COMPARE_ALIGN_BLOCK = 8; // CompareScalar按256B对齐，即8个block
+
+inline uint32_t AlignUp(uint32_t num, uint32_t align)
+{
+    return (num + align - 1) / align * align;
+}
+
+struct SelectV2GradFallbackPlan {
+    uint8_t accInWorkspace = 0; // 累加区放不进UB，改在workspace里累加
+    uint32_t accBytes = 0;      // 常驻UB的累加区和转回half的区域
+    uint32_t ubDataBytes = 0;   // 每个元素在UB里占用的字节数
+    uint32_t tileDataNum = 0;   // 为0表示UB放不下一个tile
+};
+
+// tile里的数据数量按CompareScalar的256B对齐，为0表示UB放不下一个tile
+inline uint32_t GetSelectV2GradTileDataNum(uint64_t ubSize, uint32_t accBytes, uint32_t ubDataBytes)
+{
+    uint32_t tileCondBlockNum = static_cast<uint32_t>((ubSize - accBytes) / BLOCK_SIZE / ubDataBytes);
+    tileCondBlockNum = tileCondBlockNum / COMPARE_ALIGN_BLOCK * COMPARE_ALIGN_BLOCK;
+    return tileCondBlockNum * BLOCK_SIZE;
+}
+
+// 转回half的区域只给需要规约的dx用，不需要规约的dx按tile写回，元素个数不算进来
+inline uint32_t GetSelectV2GradCastDataNum(bool x1NeedReduce, bool x2NeedReduce, uint32_t dx1DataNum, uint32_t dx2DataNum)
+{
+    uint32_t castDataNum = x1NeedReduce ? dx1DataNum : 0;
+    if (x2NeedReduce && dx2DataNum > castDataNum) {
+        castDataNum = dx2DataNum;
+    }
+    return castDataNum;
+}
+
+inline SelectV2GradFallbackPlan PlanSelectV2GradFallback(uint64_t ubSize, uint32_t dyTypeLength, bool x1NeedReduce,
+                                                         bool x2NeedReduce, uint32_t dx1DataNum, uint32_t dx2DataNum)
+{
+    SelectV2GradFallbackPlan plan;
+    // 1. 逐元素规约用的float累加区常驻UB，half还需要一块转回half的区域
+    if (x1NeedReduce) {
+        plan.accBytes += AlignUp(dx1DataNum, BLOCK_SIZE / sizeof(float)) * sizeof(float);
+    }
+    if (x2NeedReduce) {
+        plan.accBytes += AlignUp(dx2DataNum, BLOCK_SIZE / sizeof(float)) * sizeof(float);
+    }
+    if (dyTypeLength == sizeof(uint16_t)) {
+        uint32_t castDataNum = GetSelectV2GradCastDataNum(x1NeedReduce, x2NeedReduce, dx1DataNum, dx2DataNum);
+        plan.accBytes += AlignUp(castDataNum, BLOCK_SIZE / sizeof(uint16_t)) * sizeof(uint16_t);
+    }
+    // 被广播的操作数过大时累加区会挤占tile，改在workspace里累加，UB全部留给tile
+    if (plan.accBytes > ubSize / 2) {
+        plan.accInWorkspace = 1;
+        plan.accBytes = 0;
+    }
+
+    // 2. 每个元素在UB里占用的字节数
+    // 队列：condition、dy，不需要规约的dx1/dx2；临时：condition转half、selMask、全0的tile，规约时还有选出来的tile
+    plan.ubDataBytes = BUFFER_NUM * (1 + dyTypeLength) + sizeof(uint16_t) + 1 + dyTypeLength;
+    plan.ubDataBytes += x1NeedReduce ? 0 : BUFFER_NUM * dyTypeLength;
+    plan.ubDataBytes += x2NeedReduce ? 0 : BUFFER_NUM * dyTypeLength;
+    plan.ubDataBytes += (x1NeedReduce || x2NeedReduce) ? dyTypeLength : 0;
+    plan.tileDataNum = GetSelectV2GradTileDataNum(ubSize, plan.accBytes, plan.ubDataBytes);
+    return plan;
+}
+
+// KernelSelectV2Grad::Init实际申请的UB字节数，和Init里的InitBuffer一一对应，改Init时要同步改这里
+inline uint64_t GetSelectV2GradFallbackKernelUbBytes(const SelectV2GradFallbackPlan& plan, uint32_t dyTypeLength,
+                                                     bool x1NeedReduce, bool x2NeedReduce,
+                                                     uint32_t dx1DataNum, uint32_t dx2DataNum)
+{
+    uint64_t tileDataNum = plan.tileDataNum;
+    uint64_t bytes = BUFFER_NUM * tileDataNum * (1 + dyTypeLength); // condition、dy队列
+    bytes += tileDataNum * (sizeof(uint16_t) + 1 + dyTypeLength);   // tmp1、tmp2、zeroBuf
+    bytes += (x1NeedReduce || x2NeedReduce) ? tileDataNum * dyTypeLength : 0; // selBuf
+    if (!x1NeedReduce) {
+        bytes += BUFFER_NUM * tileDataNum * dyTypeLength;
+    } else if (!plan.accInWorkspace) {
+        bytes += AlignUp(dx1DataNum * sizeof(float), BLOCK_SIZE);
+    }
+    if (!x2NeedReduce) {
+        bytes += BUFFER_NUM * tileDataNum * dyTypeLength;
+    } else if (!plan.accInWorkspace) {
+        bytes += AlignUp(dx2DataNum * sizeof(float), BLOCK_SIZE);
+    }
+    if (dyTypeLength == sizeof(uint16_t) && (x1NeedReduce || x2NeedReduce) && !plan.accInWorkspace) {
+        uint32_t castDataNum = GetSelectV2GradCastDataNum(x1NeedReduce, x2NeedReduce, dx1DataNum, dx2DataNum);
+        bytes += AlignUp(castDataNum * sizeof(uint16_t), BLOCK_SIZE);
+    }
+    return bytes;
+}
+}
@@ -26,6 +26,31 @@ BEGIN_TILING_DATA_DEF(SelectV2TilingData)
     TILING_DATA_FIELD_DEF(uint8_t, x1NeedBroadcast);
     TILING_DATA_FIELD_DEF(uint8_t, x2NeedBroadcast);
     
+    // 融合尾处理：按位表示 scale、加标量、加张量bias、exp、relu，为0时不做
+    TILING_DATA_FIELD_DEF(uint8_t, epilogueFlags);
+    TILING_DATA_FIELD_DEF(float, epilogueScale);
+    TILING_DATA_FIELD_DEF(float, epilogueAddScalar);
+    TILING_DATA_FIELD_DEF(uint8_t, biasNeedBroadcast);
+    TILING_DATA_FIELD_DEF_ARR(uint32_t, 8, biasStrides); // bias的strides
+    
+    // 小张量路径：不广播且一个tile就能放下时为1，单buffer一次搬完
+    TILING_DATA_FIELD_DEF(uint8_t, tinyTensor);
+    
+    // 外轴/内轴广播的专用路径：y看成[outerNum, innerNum]，tileReuse为1时以下字段才会被使用
+    TILING_DATA_FIELD_DEF(uint8_t, tileReuse);
+    TILING_DATA_FIELD_DEF(uint32_t, outerNum);           // y的外轴长度（行数）
+    TILING_DATA_FIELD_DEF(uint32_t, innerNum);           // y的内轴长度（列数）
+    TILING_DATA_FIELD_DEF(uint32_t, tileRowNum);         // 一个tile里的行数
+    TILING_DATA_FIELD_DEF(uint32_t, tileColNum);         // 一个tile里的列数
+    TILING_DATA_FIELD_DEF(uint8_t, condMode);            // 输入的广播方式：0完整、1整行、2整列、3标量
+    TILING_DATA_FIELD_DEF(uint8_t, x1Mode);
+    TILING_DATA_FIELD_DEF(uint8_t, x2Mode);
+    
+    // tf Select按行选择的专用路径：rowCopy为1时按condition逐行把x1或x2的整行搬到y
+    TILING_DATA_FIELD_DEF(uint8_t, rowCopy);
+    TILING_DATA_FIELD_DEF(uint32_t, rowNum);             // y第0维的长度
+    TILING_DATA_FIELD_DEF(uint32_t, rowDataNum);         // 每行的元素个数
+    
 END_TILING_DATA_DEF;
 
 REGISTER_TILING_DATA_CLASS(SelectV2, SelectV2TilingData)
@@ -0,0 +1,318 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "select_v2_broadcast.h"
+
+// SelectV2的tiling计算，不依赖CANN，TilingFunc和dry-run工具共用同一份逻辑
+namespace optiling {
+const uint32_t BLOCK_SIZE = 32; // block字节数，常量
+const uint32_t BUFFER_NUM = 2;	// double buffer，常量
+// 元素个数小于这个值且不广播时走小张量路径。按tiling报告的带宽模型，4095个元素时tiny路径比队列路径快6.9%（310b float）~11.0%（910 int8），
+// 目标是至少快5%，见testcases/test_select_v2_tiny_latency.cpp；翻倍到8192时910b上int32已放不进单个tile，310b float也只剩约5.3%
+const uint32_t TINY_DATA_NUM = 4096;
+// 融合尾处理，和kernel里的定义一致
+const uint8_t EPILOGUE_SCALE = 1;
+const uint8_t EPILOGUE_ADD_SCALAR = 2;
+const uint8_t EPILOGUE_ADD_TENSOR = 4;
+const uint8_t EPILOGUE_EXP = 8;
+const uint8_t EPILOGUE_RELU = 16;
+
+// 只保存维度的shape，接口和gert::Shape一致
+struct TilingShape {
+    std::vector<int64_t> dims;
+
+    size_t GetDimNum() const { return dims.size(); }
+    int64_t GetDim(size_t idx) const { return dims[idx]; }
+    void SetDimNum(size_t dimNum) { dims.resize(dimNum, 1); }
+    void SetDim(size_t idx, int64_t dim) { dims[idx] = dim; }
+    int64_t GetShapeSize() const
+    {
+        int64_t size = 1;
+        for (int64_t dim : dims) {
+            size *= dim;
+        }
+        return size;
+    }
+};
+
+// x1、x2、y、bias支持的数据类型，condition固定为bool
+enum class SelectV2DataType : uint8_t {
+    FLOAT16,
+    FLOAT,
+    INT8,
+    INT32,
+    OTHER
+};
+
+inline uint32_t GetSelectV2TypeLength(SelectV2DataType dataType)
+{
+    switch (dataType) {
+        case SelectV2DataType::FLOAT16:
+            return 2;
+        case SelectV2DataType::FLOAT:
+        case SelectV2DataType::INT32:
+            return 4;
+        case SelectV2DataType::INT8:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+struct SelectV2TilingInput {
+    TilingShape condShape;
+    TilingShape x1Shape;
+    TilingShape x2Shape;
+    TilingShape yShape;
+    TilingShape biasShape;
+    bool hasBias = false;
+    SelectV2DataType x1DataType = SelectV2DataType::OTHER;
+    SelectV2DataType x2DataType = SelectV2DataType::OTHER;
+    SelectV2DataType yDataType = SelectV2DataType::OTHER;
+    SelectV2DataType biasDataType = SelectV2DataType::OTHER;
+    float epilogueScale = 1.0f;
+    float epilogueAddScalar = 0.0f;
+    const char* epilogueActivation = nullptr;
+    bool rowSelect = false;
+    uint64_t ubSize = 0;
+};
+
+// 和SelectV2TilingData的字段一一对应，rate是每个元素在单个buffer里占的字节数，排查时用
+struct SelectV2TilingParam {
+    uint32_t smallDataNum = 0;
+    uint32_t finalSmallTileNum = 0;
+    uint32_t tileDataNum = 0;
+    uint32_t smallTailDataNum = 0;
+    uint8_t needBroadcast = 0;
+    uint16_t yShape[MAX_BROADCAST_DIM] {};
+    uint8_t yDimNum = 0;
+    uint32_t condStrides[MAX_BROADCAST_DIM] {};
+    uint32_t x1Strides[MAX_BROADCAST_DIM] {};
+    uint32_t x2Strides[MAX_BROADCAST_DIM] {};
+    uint32_t yStrides[MAX_BROADCAST_DIM] {};
+    uint8_t condNeedBroadcast = 0;
+    uint8_t x1NeedBroadcast = 0;
+    uint8_t x2NeedBroadcast = 0;
+    uint8_t epilogueFlags = 0;
+    float epilogueScale = 1.0f;
+    float epilogueAddScalar = 0.0f;
+    uint8_t biasNeedBroadcast = 0;
+    uint32_t biasStrides[MAX_BROADCAST_DIM] {};
+    uint8_t tinyTensor = 0;
+    uint8_t tileReuse = 0;
+    uint32_t outerNum = 0;
+    uint32_t innerNum = 0;
+    uint32_t tileRowNum = 0;
+    uint32_t tileColNum = 0;
+    uint8_t condMode = 0;
+    uint8_t x1Mode = 0;
+    uint8_t x2Mode = 0;
+    uint8_t rowCopy = 0;
+    uint32_t rowNum = 0;
+    uint32_t rowDataNum = 0;
+    uint32_t rate = 0;
+};
+
+// 不支持的shape、类型或属性返回false
+inline bool CalcSelectV2Tiling(const SelectV2TilingInput& input, SelectV2TilingParam& param)
+{
+    /// 广播相关tiling
+    // 1. 获取输入输出shape
+    TilingShape condShape = input.condShape;
+    const TilingShape& x1Shape = input.x1Shape;
+    const TilingShape& x2Shape = input.x2Shape;
+    const TilingShape& yShape = input.yShape;
+    auto condShapeSize = condShape.GetShapeSize();
+    auto x1ShapeSize = x1Shape.GetShapeSize();
+    auto x2ShapeSize = x2Shape.GetShapeSize();
+    auto yShapeSize = yShape.GetShapeSize();
+
+    // tf Select按行选择：condition [N] 对齐y的第0维，补成 [N,1,...,1] 后按普通广播处理
+    bool rowSelect = input.rowSelect && condShape.GetDimNum() == 1 &&
+                     yShape.GetDimNum() > 1 && condShape.GetDim(0) == yShape.GetDim(0);
+    if (rowSelect) {
+        condShape.SetDimNum(yShape.GetDimNum());
+        for (size_t i = 1; i < yShape.GetDimNum(); i++) {
+            condShape.SetDim(i, 1);
+        }
+    }
+
+    // 融合尾处理：y = act(y * scale + addScalar + bias)，只支持浮点输出
+    const char* activation = input.epilogueActivation;
+    uint8_t epilogueFlags = 0;
+    if (input.epilogueScale != 1.0f) {
+        epilogueFlags |= EPILOGUE_SCALE;
+    }
+    if (input.epilogueAddScalar != 0.0f) {
+        epilogueFlags |= EPILOGUE_ADD_SCALAR;
+    }
+    if (input.hasBias) {
+        epilogueFlags |= EPILOGUE_ADD_TENSOR;
+    }
+    if (activation != nullptr && strcmp(activation, "exp") == 0) {
+        epilogueFlags |= EPILOGUE_EXP;
+    } else if (activation != nullptr && strcmp(activation, "relu") == 0) {
+        epilogueFlags |= EPILOGUE_RELU;
+    } else if (activation != nullptr && strcmp(activation, "none") != 0) {
+        return false;
+    }
+    SelectV2DataType yDataType = input.yDataType;
+    if (epilogueFlags != 0 && yDataType != SelectV2DataType::FLOAT16 && yDataType != SelectV2DataType::FLOAT) {
+        return false;
+    }
+    if (input.hasBias && input.biasDataType != yDataType) {
+        return false;
+    }
+    param.epilogueFlags = epilogueFlags;
+    param.epilogueScale = input.epilogueScale;
+    param.epilogueAddScalar = input.epilogueAddScalar;
+
+    // 判断是否需要广播，bias需要广播时也走广播kernel
+    uint8_t condNeedBroadcast = condShapeSize != yShapeSize;
+    uint8_t x1NeedBroadcast = x1ShapeSize != yShapeSize;
+    uint8_t x2NeedBroadcast = x2ShapeSize != yShapeSize;
+    uint8_t biasNeedBroadcast = input.hasBias && input.biasShape.GetShapeSize() != yShapeSize;
+    uint8_t needBroadcast = condNeedBroadcast || x1NeedBroadcast || x2NeedBroadcast || biasNeedBroadcast;
+    param.needBroadcast = needBroadcast;
+    if (needBroadcast) {
+        uint8_t yDimNum = static_cast<uint8_t>(yShape.GetDimNum());
+        if (yShape.GetDimNum() > MAX_BROADCAST_DIM || condShape.GetDimNum() > MAX_BROADCAST_DIM ||
+            x1Shape.GetDimNum() > MAX_BROADCAST_DIM || x2Shape.GetDimNum() > MAX_BROADCAST_DIM) {
+            return false;
+        }
+        if (biasNeedBroadcast) {
+            if (input.biasShape.GetDimNum() > MAX_BROADCAST_DIM) {
+                return false;
+            }
+            GetBroadcastStrides(input.biasShape, yDimNum, param.biasStrides);
+        }
+        param.biasNeedBroadcast = biasNeedBroadcast;
+        GetBroadcastShape(yShape, param.yShape);
+
+        // 2. 获取输入输出strides
+        GetBroadcastStrides(yShape, yDimNum, param.yStrides);
+        GetBroadcastStrides(condShape, yDimNum, param.condStrides);
+        GetBroadcastStrides(x1Shape, yDimNum, param.x1Strides);
+        GetBroadcastStrides(x2Shape, yDimNum, param.x2Strides);
+
+        param.yDimNum = yDimNum;
+        param.condNeedBroadcast = condNeedBroadcast;
+        param.x1NeedBroadcast = x1NeedBroadcast;
+        param.x2NeedBroadcast = x2NeedBroadcast;
+
+        // 3. 外轴/内轴广播：找一个切分维，让每个输入都是完整、整行、整列或标量之一，就能走tile复用的专用kernel
+        // condition是1字节，内轴按32个元素对齐时每行都能整块搬运；bias需要广播时仍走通用广播kernel
+        for (int32_t splitDim = yDimNum - 1; splitDim > 0 && !biasNeedBroadcast; splitDim--) {
+            uint32_t splitInnerNum = 1, splitOuterNum = 1;
+            for (int32_t i = 0; i < yDimNum; i++) {
+                if (i < splitDim) {
+                    splitInnerNum *= param.yShape[i];
+                } else {
+                    splitOuterNum *= param.yShape[i];
+                }
+            }
+            uint8_t condMode = GetOperandMode(param.yShape, param.condStrides, yDimNum, splitDim);
+            uint8_t x1Mode = GetOperandMode(param.yShape, param.x1Strides, yDimNum, splitDim);
+            uint8_t x2Mode = GetOperandMode(param.yShape, param.x2Strides, yDimNum, splitDim);
+            if (splitInnerNum % BLOCK_SIZE != 0 || splitOuterNum <= 1 ||
+                condMode == OPERAND_OTHER || x1Mode == OPERAND_OTHER || x2Mode == OPERAND_OTHER) {
+                continue;
+            }
+            param.tileReuse = 1;
+            param.outerNum = splitOuterNum;
+            param.innerNum = splitInnerNum;
+            param.condMode = condMode;
+            param.x1Mode = x1Mode;
+            param.x2Mode = x2Mode;
+            break;
+        }
+    }
+
+    // 按行选择且x1、x2都是完整shape、类型一致、没有尾处理时，每行整块从x1或x2搬到y，不做逐元素计算
+    param.rowCopy = rowSelect && yShapeSize > 0 && !x1NeedBroadcast && !x2NeedBroadcast && epilogueFlags == 0 &&
+                    input.x1DataType == yDataType && input.x2DataType == yDataType;
+    if (param.rowCopy) {
+        param.rowNum = static_cast<uint32_t>(yShape.GetDim(0));
+        param.rowDataNum = static_cast<uint32_t>(yShapeSize / yShape.GetDim(0));
+    }
+
+    // 获取输入数据数量, totalDataNum表示几个元素
+    uint32_t totalDataNum = static_cast<uint32_t>(yShapeSize);
+
+    // typeLength表示输入的数据类型占几个字节，condition是bool
+    uint32_t condTypeLength = 1;
+    uint32_t x1TypeLength = GetSelectV2TypeLength(input.x1DataType);
+    uint32_t r = x1TypeLength / condTypeLength;
+
+    // 总共有几个 cond 块
+    uint32_t condBlockNum = (totalDataNum + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    /// 计算每个tile内的参数
+    // 1. tileCondBlockNum 一个tile里可以存几个 condBlock
+    uint32_t rate = 3 * r + 1;
+    SelectV2DataType x1DataType = input.x1DataType;
+    SelectV2DataType x2DataType = input.x2DataType;
+    if (x1DataType != x2DataType || x1DataType != yDataType) {
+        // 类型混合时在UB里做类型提升：两个输入都是half时在half上算，否则在float上算
+        uint32_t x2TypeLength = GetSelectV2TypeLength(x2DataType);
+        uint32_t yTypeLength = GetSelectV2TypeLength(yDataType);
+        uint32_t computeTypeLength = (x1DataType == SelectV2DataType::FLOAT16 && x2DataType == SelectV2DataType::FLOAT16) ? 2 : 4;
+        uint32_t tmpLength = 2 + 1; // condition转half、selMask
+        tmpLength += x1TypeLength != computeTypeLength ? computeTypeLength : 0;
+        tmpLength += x2TypeLength != computeTypeLength ? computeTypeLength : 0;
+        tmpLength += yTypeLength != computeTypeLength ? computeTypeLength : 0;
+        rate = x1TypeLength + x2TypeLength + yTypeLength + condTypeLength + (tmpLength + BUFFER_NUM - 1) / BUFFER_NUM;
+    } else {
+        switch (x1DataType) {
+            case SelectV2DataType::FLOAT16:
+                rate += 3;
+                break;
+            case SelectV2DataType::INT8:
+                rate += 9;
+                break;
+            case SelectV2DataType::INT32:
+                rate += 9;
+                break;
+            case SelectV2DataType::FLOAT:
+                rate += 3;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    if (epilogueFlags & EPILOGUE_ADD_TENSOR) {
+        rate += GetSelectV2TypeLength(yDataType);
+    }
+    param.rate = rate;
+
+    uint32_t tileCondBlockNum = input.ubSize / BUFFER_NUM / BLOCK_SIZE / rate;
+    if (tileCondBlockNum == 0) {
+        return false;
+    }
+    // 2. 一个tile里的数据数量
+    uint32_t tileDataNum = BLOCK_SIZE * tileCondBlockNum / condTypeLength;
+
+    uint32_t smallDataNum = condBlockNum * BLOCK_SIZE / condTypeLength;
+    uint32_t smallTileNum = condBlockNum / tileCondBlockNum;
+    uint32_t finalSmallTileNum = (condBlockNum % tileCondBlockNum == 0) ? smallTileNum : smallTileNum + 1;
+    uint32_t smallTailDataNum = smallDataNum - (tileDataNum * smallTileNum);
+    smallTailDataNum = smallTailDataNum == 0? tileDataNum : smallTailDataNum;
+
+    // 小张量：单核单tile、不开double buffer，UB只按实际数据量分配，省掉队列同步的开销
+    param.tinyTensor = !needBroadcast && totalDataNum < TINY_DATA_NUM && finalSmallTileNum == 1;
+
+    // tile复用时非完整的输入只占一块UB，tileDataNum沿用上面的结果不会超；行短时一个tile放多行，行长时放一行的一段
+    if (param.tileReuse) {
+        param.tileRowNum = param.innerNum <= tileDataNum ? tileDataNum / param.innerNum : 1;
+        param.tileColNum = param.innerNum <= tileDataNum ? param.innerNum : tileDataNum;
+    }
+
+    param.smallDataNum = smallDataNum;
+    param.finalSmallTileNum = finalSmallTileNum;
+    param.tileDataNum = tileDataNum;
+    param.smallTailDataNum = smallTailDataNum;
+    return true;
+}
+}
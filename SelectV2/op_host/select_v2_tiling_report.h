@@ -0,0 +1,245 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "select_v2_tiling_calc.h"
+
+// 把tiling结果整理成可读的文本，附带GM搬运量、UB占用和按带宽模型估算的耗时
+// 日志级别为debug时TilingFunc写进plog，dry-run工具也直接调用
+namespace optiling {
+// 粗略的单核模型，只用来比较不同路径的量级，不是精确的性能预测
+struct SelectV2SocModel {
+    const char* name;
+    uint64_t ubSize;        // 单核UB字节数
+    double gmBandwidth;     // 单核GM搬运带宽，GB/s
+    double scalarReadNs;    // 标量从GM读一个元素的耗时
+    double tileOverheadNs;  // 每个tile队列同步、指令下发的固定开销
+    double launchUs;        // kernel下发的固定开销
+};
+
+const SelectV2SocModel SELECT_V2_SOC_MODELS[] = {
+    {"ascend910", 262144, 50.0, 20.0, 1500.0, 5.0},
+    {"ascend910b", 196608, 80.0, 15.0, 1000.0, 4.0},
+    {"ascend310p", 262144, 25.0, 25.0, 1500.0, 6.0},
+    {"ascend310b", 262144, 12.0, 30.0, 2000.0, 8.0},
+};
+
+inline const SelectV2SocModel* FindSelectV2SocModel(const char* name)
+{
+    for (const SelectV2SocModel& model : SELECT_V2_SOC_MODELS) {
+        if (strcmp(model.name, name) == 0) {
+            return &model;
+        }
+    }
+    return nullptr;
+}
+
+inline const char* GetSelectV2TypeName(SelectV2DataType dataType)
+{
+    switch (dataType) {
+        case SelectV2DataType::FLOAT16:
+            return "float16";
+        case SelectV2DataType::FLOAT:
+            return "float";
+        case SelectV2DataType::INT8:
+            return "int8";
+        case SelectV2DataType::INT32:
+            return "int32";
+        default:
+            return "other";
+    }
+}
+
+// 和kernel入口的判断顺序一致
+inline const char* GetSelectV2TilingPath(const SelectV2TilingParam& param)
+{
+    if (param.tinyTensor) {
+        return "tiny";
+    } else if (param.rowCopy) {
+        return "row-copy";
+    } else if (param.tileReuse) {
+        return "tile-reuse";
+    } else if (param.needBroadcast) {
+        return "broadcast";
+    }
+    return "elementwise";
+}
+
+struct SelectV2TilingEstimate {
+    uint64_t gmReadBytes = 0;
+    uint64_t gmWriteBytes = 0;
+    uint64_t scalarReadNum = 0;  // 逐元素或逐行用GetValue从GM读取的次数
+    uint64_t tileNum = 0;
+    uint64_t ubBytes = 0;        // 按tiling规划的UB占用
+    double timeUs = 0;
+};
+
+inline SelectV2TilingEstimate EstimateSelectV2Tiling(const SelectV2TilingInput& input, const SelectV2TilingParam& param,
+                                                     const SelectV2SocModel& model)
+{
+    SelectV2TilingEstimate estimate;
+    uint64_t x1TypeLength = GetSelectV2TypeLength(input.x1DataType);
+    uint64_t x2TypeLength = GetSelectV2TypeLength(input.x2DataType);
+    uint64_t yTypeLength = GetSelectV2TypeLength(input.yDataType);
+    uint64_t biasTypeLength = (param.epilogueFlags & EPILOGUE_ADD_TENSOR) ? yTypeLength : 0;
+    uint64_t totalDataNum = static_cast<uint64_t>(input.yShape.GetShapeSize());
+    double tileOverheadNs = model.tileOverheadNs;
+
+    if (param.tinyTensor) {
+        estimate.gmReadBytes = param.smallDataNum * (1 + x1TypeLength + x2TypeLength + biasTypeLength);
+        estimate.gmWriteBytes = param.smallDataNum * yTypeLength;
+        estimate.tileNum = 1;
+        estimate.ubBytes = static_cast<uint64_t>(param.smallDataNum) * param.rate;
+        tileOverheadNs /= 2; // 没有队列同步
+    } else if (param.rowCopy) {
+        estimate.gmReadBytes = totalDataNum * yTypeLength;
+        estimate.gmWriteBytes = totalDataNum * yTypeLength;
+        estimate.scalarReadNum = param.rowNum;
+        estimate.tileNum = (totalDataNum + param.tileDataNum - 1) / param.tileDataNum;
+        estimate.ubBytes = static_cast<uint64_t>(BUFFER_NUM) * param.tileDataNum * yTypeLength;
+    } else if (param.tileReuse) {
+        uint64_t colChunkNum = (param.innerNum + param.tileColNum - 1) / param.tileColNum;
+        const uint8_t modes[] = {param.condMode, param.x1Mode, param.x2Mode};
+        const uint64_t typeLengths[] = {1, x1TypeLength, x2TypeLength};
+        for (int i = 0; i < 3; i++) {
+            if (modes[i] == OPERAND_FULL) {
+                estimate.gmReadBytes += totalDataNum * typeLengths[i];
+            } else if (modes[i] == OPERAND_ROW) {
+                estimate.gmReadBytes += param.innerNum * typeLengths[i];
+            } else if (modes[i] == OPERAND_COL) {
+                estimate.gmReadBytes += param.outerNum * colChunkNum * typeLengths[i];
+            } else {
+                estimate.scalarReadNum += 1;
+            }
+        }
+        estimate.gmReadBytes += totalDataNum * biasTypeLength;
+        estimate.gmWriteBytes = totalDataNum * yTypeLength;
+        estimate.tileNum = colChunkNum * ((param.outerNum + param.tileRowNum - 1) / param.tileRowNum);
+        estimate.ubBytes = static_cast<uint64_t>(BUFFER_NUM) * param.tileDataNum * param.rate;
+    } else {
+        // 需要广播的输入逐元素GetValue，其余整块DataCopy
+        const uint8_t needBroadcasts[] = {param.condNeedBroadcast, param.x1NeedBroadcast, param.x2NeedBroadcast,
+                                          param.biasNeedBroadcast};
+        const uint64_t typeLengths[] = {1, x1TypeLength, x2TypeLength, biasTypeLength};
+        for (int i = 0; i < 4; i++) {
+            if (typeLengths[i] == 0) {
+                continue;
+            }
+            if (needBroadcasts[i]) {
+                estimate.scalarReadNum += param.smallDataNum;
+            } else {
+                estimate.gmReadBytes += param.smallDataNum * typeLengths[i];
+            }
+        }
+        estimate.gmWriteBytes = param.smallDataNum * yTypeLength;
+        estimate.tileNum = param.finalSmallTileNum;
+        estimate.ubBytes = static_cast<uint64_t>(BUFFER_NUM) * param.tileDataNum * param.rate;
+    }
+
+    double gmBytes = static_cast<double>(estimate.gmReadBytes + estimate.gmWriteBytes);
+    estimate.timeUs = model.launchUs + gmBytes / (model.gmBandwidth * 1e3) +
+                      (estimate.scalarReadNum * model.scalarReadNs + estimate.tileNum * tileOverheadNs) / 1e3;
+    return estimate;
+}
+
+inline void AppendShape(std::string& out, const TilingShape& shape)
+{
+    out += "[";
+    for (size_t i = 0; i < shape.GetDimNum(); i++) {
+        out += (i == 0 ? "" : ",") + std::to_string(shape.GetDim(i));
+    }
+    out += "]";
+}
+
+template <typename T>
+inline void AppendArray(std::string& out, const char* name, const T* values, uint32_t num)
+{
+    out += std::string("  ") + name + " = [";
+    for (uint32_t i = 0; i < num; i++) {
+        out += (i == 0 ? "" : ",") + std::to_string(values[i]);
+    }
+    out += "]\n";
+}
+
+// model为空（SoC没有带宽模型）时不给估算，只输出tiling
+inline std::string FormatSelectV2Tiling(const SelectV2TilingInput& input, const SelectV2TilingParam& param,
+                                        const SelectV2SocModel* model)
+{
+    std::string out = "SelectV2 tiling: condition ";
+    AppendShape(out, input.condShape);
+    out += " bool, x1 ";
+    AppendShape(out, input.x1Shape);
+    out += std::string(" ") + GetSelectV2TypeName(input.x1DataType) + ", x2 ";
+    AppendShape(out, input.x2Shape);
+    out += std::string(" ") + GetSelectV2TypeName(input.x2DataType) + ", y ";
+    AppendShape(out, input.yShape);
+    out += std::string(" ") + GetSelectV2TypeName(input.yDataType);
+    if (input.hasBias) {
+        out += ", bias ";
+        AppendShape(out, input.biasShape);
+    }
+    out += std::string("\npath: ") + GetSelectV2TilingPath(param) + "\n";
+
+    out += "SelectV2TilingData:\n";
+    auto field = [&out](const char* name, double value) {
+        char line[96];
+        snprintf(line, sizeof(line), "  %s = %g\n", name, value);
+        out += line;
+    };
+    field("smallDataNum", param.smallDataNum);
+    field("finalSmallTileNum", param.finalSmallTileNum);
+    field("tileDataNum", param.tileDataNum);
+    field("smallTailDataNum", param.smallTailDataNum);
+    field("needBroadcast", param.needBroadcast);
+    AppendArray(out, "yShape", param.yShape, param.yDimNum);
+    field("yDimNum", param.yDimNum);
+    AppendArray(out, "condStrides", param.condStrides, param.yDimNum);
+    AppendArray(out, "x1Strides", param.x1Strides, param.yDimNum);
+    AppendArray(out, "x2Strides", param.x2Strides, param.yDimNum);
+    AppendArray(out, "yStrides", param.yStrides, param.yDimNum);
+    field("condNeedBroadcast", param.condNeedBroadcast);
+    field("x1NeedBroadcast", param.x1NeedBroadcast);
+    field("x2NeedBroadcast", param.x2NeedBroadcast);
+    field("epilogueFlags", param.epilogueFlags);
+    field("epilogueScale", param.epilogueScale);
+    field("epilogueAddScalar", param.epilogueAddScalar);
+    field("biasNeedBroadcast", param.biasNeedBroadcast);
+    AppendArray(out, "biasStrides", param.biasStrides, param.yDimNum);
+    field("tinyTensor", param.tinyTensor);
+    field("tileReuse", param.tileReuse);
+    field("outerNum", param.outerNum);
+    field("innerNum", param.innerNum);
+    field("tileRowNum", param.tileRowNum);
+    field("tileColNum", param.tileColNum);
+    field("condMode", param.condMode);
+    field("x1Mode", param.x1Mode);
+    field("x2Mode", param.x2Mode);
+    field("rowCopy", param.rowCopy);
+    field("rowNum", param.rowNum);
+    field("rowDataNum", param.rowDataNum);
+    field("rate", param.rate);
+
+    if (model == nullptr) {
+        out += "estimate: skipped, unknown soc\n";
+        return out;
+    }
+    SelectV2TilingEstimate estimate = EstimateSelectV2Tiling(input, param, *model);
+    char summary[512];
+    snprintf(summary, sizeof(summary),
+             "estimate (%s, 1 core):\n"
+             "  GM read bytes = %llu\n"
+             "  GM write bytes = %llu\n"
+             "  scalar GM reads = %llu\n"
+             "  tiles = %llu\n"
+             "  UB planned = %llu / %llu bytes (%.1f%%)\n"
+             "  predicted time = %.2f us\n",
+             model->name, static_cast<unsigned long long>(estimate.gmReadBytes),
+             static_cast<unsigned long long>(estimate.gmWriteBytes),
+             static_cast<unsigned long long>(estimate.scalarReadNum),
+             static_cast<unsigned long long>(estimate.tileNum),
+             static_cast<unsigned long long>(estimate.ubBytes), static_cast<unsigned long long>(input.ubSize),
+             input.ubSize == 0 ? 0.0 : 100.0 * estimate.ubBytes / input.ubSize, estimate.timeUs);
+    out += summary;
+    return out;
+}
+}
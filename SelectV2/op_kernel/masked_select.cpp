@@ -0,0 +1,255 @@
+#include "kernel_operator.h"
+
+constexpr int32_t BUFFER_NUM = 2;
+constexpr uint32_t COMPARE_ALIGN_NUM = 128; // CompareScalar按256B对齐，half下是128个数
+constexpr uint32_t COUNT_SLOT_NUM = 16;     // 每个核的计数槽占16个int32（64B），和tiling里的COUNT_SLOT_SIZE对应
+
+class KernelMaskedSelect {
+private:
+    uint32_t tileDataNum; // 除了最后一次，tile里的数据数量
+    uint32_t dataNum; // 这个核要计算的数据数量
+    uint32_t tileNum; // 这个核要计算的tile数量
+    uint32_t tailDataNum; // 这个核最后一次计算的数据数量
+    uint32_t processDataNum; // 这次要处理的数据数量
+    uint32_t validDataNum; // 这次要处理的数据里真正有效的数量，去掉了32对齐补出来的部分
+    uint32_t compareDataNum; // processDataNum按CompareScalar对齐后的数量
+
+    uint32_t totalDataNum; // 整个输入的真实元素个数
+    uint32_t coreOffset; // 这个核的第一个数据在整个输入里的下标
+    uint32_t outOffset; // 下一次写y的位置
+    uint32_t gatheredNum; // 这次GatherMask挑出来的数量
+    uint8_t emitIndices;
+
+public:
+    __aicore__ inline KernelMaskedSelect() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR x, GM_ADDR y, GM_ADDR count, GM_ADDR workspace,
+                                uint32_t bigCoreDataNum, uint32_t smallCoreDataNum,
+                                uint32_t finalBigTileNum, uint32_t finalSmallTileNum,
+                                uint32_t tileDataNum, uint32_t bigTailDataNum, uint32_t smallTailDataNum,
+                                uint32_t tailBlockNum, uint32_t totalDataNum, uint8_t emitIndices,
+                                AscendC::TPipe* pipeIn)
+    {
+        uint32_t blockNum = AscendC::GetBlockNum();
+        ASSERT(blockNum != 0 && "GetBlockNum() is 0");
+        uint32_t coreId = AscendC::GetBlockIdx();
+
+        this->tileDataNum = tileDataNum;
+        this->totalDataNum = totalDataNum;
+        this->emitIndices = emitIndices;
+
+        if (coreId < tailBlockNum) {
+            this->dataNum = bigCoreDataNum;
+            this->tileNum = finalBigTileNum;
+            this->tailDataNum = bigTailDataNum;
+            this->coreOffset = bigCoreDataNum * coreId;
+        } else {
+            this->dataNum = smallCoreDataNum;
+            this->tileNum = finalSmallTileNum;
+            this->tailDataNum = smallTailDataNum;
+            this->coreOffset = bigCoreDataNum * tailBlockNum + smallCoreDataNum * (coreId - tailBlockNum);
+        }
+
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition + this->coreOffset, this->dataNum);
+        xGm.SetGlobalBuffer((__gm__ DTYPE_X *)x + this->coreOffset, this->dataNum);
+        yGm.SetGlobalBuffer((__gm__ DTYPE_Y *)y, this->totalDataNum);
+        countGm.SetGlobalBuffer((__gm__ int32_t *)count, 1);
+        countSlotGm.SetGlobalBuffer((__gm__ int32_t *)workspace, blockNum * COUNT_SLOT_NUM);
+
+        pipe = pipeIn;
+        pipe->InitBuffer(inQueueCondition, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_CONDITION));
+        pipe->InitBuffer(outQueueY, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
+        pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
+        pipe->InitBuffer(tmp3, this->tileDataNum * sizeof(half));
+
+        if (this->emitIndices) {
+            pipe->InitBuffer(tmp4, this->tileDataNum * sizeof(int32_t));
+        } else {
+            pipe->InitBuffer(inQueueX, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_X));
+            if constexpr (std::is_same_v<DTYPE_X, int8_t>) {
+                pipe->InitBuffer(tmp4, this->tileDataNum * sizeof(half));
+            }
+        }
+    }
+
+    __aicore__ inline void Process()
+    {
+        uint32_t coreId = AscendC::GetBlockIdx();
+        uint32_t blockNum = AscendC::GetBlockNum();
+        int32_t loopCount = this->tileNum;
+
+        // 1. 先只读condition，数出这个核选中的个数，写到workspace里自己的计数槽
+        int32_t selectedNum = 0;
+        for (int32_t i = 0; i < loopCount; i++) {
+            SetTileSize(i);
+            CopyInCondition(i);
+            selectedNum += CountSelected();
+        }
+        countSlotGm.SetValue(coreId * COUNT_SLOT_NUM, selectedNum);
+        AscendC::DataCacheCleanAndInvalid<int32_t, AscendC::CacheLine::SINGLE_CACHE_LINE,
+            AscendC::DcciDst::CACHELINE_OUT>(countSlotGm[coreId * COUNT_SLOT_NUM]);
+
+        // 2. 核间同步后，对前面所有核的计数求前缀和，得到这个核在y中的起始位置
+        AscendC::SyncAll();
+        this->outOffset = 0;
+        for (uint32_t i = 0; i < coreId; i++) {
+            AscendC::DataCacheCleanAndInvalid<int32_t, AscendC::CacheLine::SINGLE_CACHE_LINE,
+                AscendC::DcciDst::CACHELINE_OUT>(countSlotGm[i * COUNT_SLOT_NUM]);
+            this->outOffset += countSlotGm.GetValue(i * COUNT_SLOT_NUM);
+        }
+
+        // 3. 再走一遍，把选中的元素（或下标）紧凑地写到y里
+        for (int32_t i = 0; i < loopCount; i++) {
+            SetTileSize(i);
+            CopyIn(i);
+            Compute(i);
+            CopyOut(i);
+        }
+
+        // 4. 最后一个核的结束位置就是总数
+        if (coreId == blockNum - 1) {
+            countGm.SetValue(0, this->outOffset);
+            AscendC::DataCacheCleanAndInvalid<int32_t, AscendC::CacheLine::SINGLE_CACHE_LINE,
+                AscendC::DcciDst::CACHELINE_OUT>(countGm);
+        }
+    }
+
+private:
+    __aicore__ inline void SetTileSize(int32_t progress)
+    {
+        this->processDataNum = (progress == this->tileNum - 1) ? this->tailDataNum : this->tileDataNum;
+        this->compareDataNum = (this->processDataNum + COMPARE_ALIGN_NUM - 1) / COMPARE_ALIGN_NUM * COMPARE_ALIGN_NUM;
+        uint32_t tileOffset = this->coreOffset + progress * this->tileDataNum;
+        uint32_t remainDataNum = this->totalDataNum > tileOffset ? this->totalDataNum - tileOffset : 0;
+        this->validDataNum = remainDataNum < this->processDataNum ? remainDataNum : this->processDataNum;
+    }
+
+    __aicore__ inline void CopyInCondition(int32_t progress)
+    {
+        AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = inQueueCondition.AllocTensor<DTYPE_CONDITION>();
+        AscendC::DataCopy(conditionLocal, conditionGm[progress * this->tileDataNum], this->processDataNum);
+        inQueueCondition.EnQue(conditionLocal);
+    }
+
+    // condition转成GatherMask用的位掩码，只有前validDataNum个位参与后面的GatherMask
+    __aicore__ inline AscendC::LocalTensor<uint8_t> BuildSelMask()
+    {
+        AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
+
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->compareDataNum);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->compareDataNum);
+
+        inQueueCondition.FreeTensor(_conditionLocal);
+        return selMask;
+    }
+
+    __aicore__ inline int32_t CountSelected()
+    {
+        AscendC::LocalTensor<uint8_t> selMask = BuildSelMask();
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<half> gatherLocal = tmp3.Get<half>();
+
+        uint64_t rsvdCnt = 0;
+        AscendC::GatherMask(gatherLocal, conditionLocal, selMask.ReinterpretCast<uint16_t>(), true,
+                            this->validDataNum, {1, 1, 8, 8}, rsvdCnt);
+        return static_cast<int32_t>(rsvdCnt);
+    }
+
+    __aicore__ inline void CopyIn(int32_t progress)
+    {
+        CopyInCondition(progress);
+        if (!this->emitIndices) {
+            AscendC::LocalTensor<DTYPE_X> xLocal = inQueueX.AllocTensor<DTYPE_X>();
+            AscendC::DataCopy(xLocal, xGm[progress * this->tileDataNum], this->processDataNum);
+            inQueueX.EnQue(xLocal);
+        }
+    }
+
+    __aicore__ inline void Compute(int32_t progress)
+    {
+        AscendC::LocalTensor<uint8_t> selMask = BuildSelMask();
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
+        uint64_t rsvdCnt = 0;
+
+        if (this->emitIndices) {
+            if constexpr (std::is_same_v<DTYPE_Y, int32_t>) {
+                AscendC::LocalTensor<int32_t> indexLocal = tmp4.Get<int32_t>();
+                int32_t firstIndex = static_cast<int32_t>(this->coreOffset + progress * this->tileDataNum);
+                AscendC::ArithProgression<int32_t>(indexLocal, firstIndex, 1, this->processDataNum);
+                AscendC::GatherMask(yLocal, indexLocal, selMask.ReinterpretCast<uint32_t>(), true,
+                                    this->validDataNum, {1, 1, 8, 8}, rsvdCnt);
+            }
+        } else if constexpr (std::is_same_v<DTYPE_X, int8_t> && std::is_same_v<DTYPE_Y, int8_t>) {
+            AscendC::LocalTensor<int8_t> _xLocal = inQueueX.DeQue<int8_t>();
+            AscendC::LocalTensor<half> xLocal = tmp3.Get<half>();
+            AscendC::LocalTensor<half> _yLocal = tmp4.Get<half>();
+
+            AscendC::Cast(xLocal, _xLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
+            AscendC::GatherMask(_yLocal, xLocal, selMask.ReinterpretCast<uint16_t>(), true,
+                                this->validDataNum, {1, 1, 8, 8}, rsvdCnt);
+            AscendC::Cast(yLocal, _yLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
+
+            inQueueX.FreeTensor(_xLocal);
+        } else if constexpr (std::is_same_v<DTYPE_X, DTYPE_Y>) {
+            // half/float/int32 直接按2字节或4字节的位掩码挑
+            using PatternType = std::conditional_t<sizeof(DTYPE_X) == sizeof(uint16_t), uint16_t, uint32_t>;
+            AscendC::LocalTensor<DTYPE_X> xLocal = inQueueX.DeQue<DTYPE_X>();
+            AscendC::GatherMask(yLocal, xLocal, selMask.ReinterpretCast<PatternType>(), true,
+                                this->validDataNum, {1, 1, 8, 8}, rsvdCnt);
+            inQueueX.FreeTensor(xLocal);
+        } else {
+            // tiling保证输出元素时y和x同类型，这里只是为了让其他类型组合能编译通过
+            AscendC::LocalTensor<DTYPE_X> xLocal = inQueueX.DeQue<DTYPE_X>();
+            inQueueX.FreeTensor(xLocal);
+        }
+
+        this->gatheredNum = static_cast<uint32_t>(rsvdCnt);
+        outQueueY.EnQue<DTYPE_Y>(yLocal);
+    }
+
+    __aicore__ inline void CopyOut(int32_t progress)
+    {
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.DeQue<DTYPE_Y>();
+        if (this->gatheredNum > 0) {
+            // 挑出来的个数不一定32B对齐，用DataCopyPad只写有效的部分，避免覆盖相邻核的结果
+            AscendC::DataCopyExtParams copyParams {1, static_cast<uint32_t>(this->gatheredNum * sizeof(DTYPE_Y)), 0, 0, 0};
+            AscendC::DataCopyPad(yGm[this->outOffset], yLocal, copyParams);
+            this->outOffset += this->gatheredNum;
+        }
+        outQueueY.FreeTensor(yLocal);
+    }
+
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueY;
+
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp3;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp4;
+
+    AscendC::GlobalTensor<DTYPE_X> xGm;
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> yGm;
+    AscendC::GlobalTensor<int32_t> countGm;
+    AscendC::GlobalTensor<int32_t> countSlotGm;
+};
+
+extern "C" __global__ __aicore__ void masked_select(GM_ADDR condition, GM_ADDR x, GM_ADDR y, GM_ADDR count, GM_ADDR workspace, GM_ADDR tiling) {
+    GET_TILING_DATA(tiling_data, tiling);
+    GM_ADDR userWorkspace = AscendC::GetUserWorkspace(workspace);
+    AscendC::TPipe pipe;
+
+    KernelMaskedSelect op;
+    op.Init(condition, x, y, count, userWorkspace,
+            tiling_data.bigCoreDataNum, tiling_data.smallCoreDataNum,
+            tiling_data.finalBigTileNum, tiling_data.finalSmallTileNum,
+            tiling_data.tileDataNum, tiling_data.bigTailDataNum, tiling_data.smallTailDataNum,
+            tiling_data.tailBlockNum, tiling_data.totalDataNum, tiling_data.emitIndices,
+            &pipe);
+    op.Process();
+}
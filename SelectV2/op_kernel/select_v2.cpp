@@ -2,6 +2,160 @@
 
 constexpr int32_t BUFFER_NUM = 2;
 
+// x1、x2、y类型不一致时在UB里做类型提升：两个输入都是half时在half上算，否则在float上算
+constexpr bool IS_MIXED_DTYPE = !std::is_same_v<DTYPE_X1, DTYPE_X2> || !std::is_same_v<DTYPE_X1, DTYPE_Y>;
+using ComputeType = std::conditional_t<std::is_same_v<DTYPE_X1, half> && std::is_same_v<DTYPE_X2, half>, half, float>;
+
+template <typename TX1, typename TX2, typename TY>
+__aicore__ inline void SelectMixedDtype(const AscendC::LocalTensor<TY>& yLocal, const AscendC::LocalTensor<uint8_t>& selMask,
+                                        const AscendC::LocalTensor<TX1>& x1Local, const AscendC::LocalTensor<TX2>& x2Local,
+                                        AscendC::TBuf<AscendC::TPosition::VECCALC>& x1Buf,
+                                        AscendC::TBuf<AscendC::TPosition::VECCALC>& x2Buf,
+                                        AscendC::TBuf<AscendC::TPosition::VECCALC>& yBuf, uint32_t count)
+{
+    AscendC::LocalTensor<ComputeType> x1Compute;
+    AscendC::LocalTensor<ComputeType> x2Compute;
+    if constexpr (std::is_same_v<TX1, ComputeType>) {
+        x1Compute = x1Local;
+    } else {
+        x1Compute = x1Buf.Get<ComputeType>();
+        AscendC::Cast(x1Compute, x1Local, AscendC::RoundMode::CAST_NONE, count);
+    }
+    if constexpr (std::is_same_v<TX2, ComputeType>) {
+        x2Compute = x2Local;
+    } else {
+        x2Compute = x2Buf.Get<ComputeType>();
+        AscendC::Cast(x2Compute, x2Local, AscendC::RoundMode::CAST_NONE, count);
+    }
+
+    if constexpr (std::is_same_v<TY, ComputeType>) {
+        AscendC::Select(yLocal, selMask, x1Compute, x2Compute, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+    } else {
+        AscendC::LocalTensor<ComputeType> yCompute = yBuf.Get<ComputeType>();
+        AscendC::Select(yCompute, selMask, x1Compute, x2Compute, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+        AscendC::Cast(yLocal, yCompute, AscendC::RoundMode::CAST_NONE, count);
+    }
+}
+
+// 各类型Compute用到的临时空间，和SelectCompute里的用法一一对应
+__aicore__ inline void InitSelectBuffers(AscendC::TPipe* pipe, AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp1,
+                                         AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp2,
+                                         AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp3,
+                                         AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp4,
+                                         AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp5, uint32_t tileDataNum)
+{
+    if constexpr (IS_MIXED_DTYPE) {
+        pipe->InitBuffer(tmp1, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, tileDataNum * sizeof(uint8_t));
+        if constexpr (!std::is_same_v<DTYPE_X1, ComputeType>) {
+            pipe->InitBuffer(tmp3, tileDataNum * sizeof(ComputeType));
+        }
+        if constexpr (!std::is_same_v<DTYPE_X2, ComputeType>) {
+            pipe->InitBuffer(tmp4, tileDataNum * sizeof(ComputeType));
+        }
+        if constexpr (!std::is_same_v<DTYPE_Y, ComputeType>) {
+            pipe->InitBuffer(tmp5, tileDataNum * sizeof(ComputeType));
+        }
+    } else if constexpr (std::is_same_v<DTYPE_X1, half>) {
+        pipe->InitBuffer(tmp1, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, tileDataNum * sizeof(uint8_t));
+    } else if constexpr (std::is_same_v<DTYPE_X1, int8_t>) {
+        pipe->InitBuffer(tmp1, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp3, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp4, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp5, tileDataNum * sizeof(uint8_t));
+    } else if constexpr (std::is_same_v<DTYPE_X1, int32_t>) {
+        pipe->InitBuffer(tmp1, tileDataNum * sizeof(int32_t));
+        pipe->InitBuffer(tmp2, tileDataNum * sizeof(int32_t));
+        pipe->InitBuffer(tmp3, tileDataNum * sizeof(half));
+    } else if constexpr (std::is_same_v<DTYPE_X1, float>) {
+        pipe->InitBuffer(tmp1, tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, tileDataNum * sizeof(uint8_t));
+    }
+}
+
+// y = condition ? x1 : x2，condition先转half和0比较得到selMask；x1/x2的内容不会被改写，广播时常驻UB的输入可以反复使用
+template <typename TX1, typename TX2, typename TY>
+__aicore__ inline void SelectCompute(const AscendC::LocalTensor<TY>& yLocal, const AscendC::LocalTensor<int8_t>& _conditionLocal,
+                                     const AscendC::LocalTensor<TX1>& x1Local, const AscendC::LocalTensor<TX2>& x2Local,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp1,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp2,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp3,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp4,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmp5, uint32_t count)
+{
+    if constexpr (IS_MIXED_DTYPE) {
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
+        
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, count);
+        SelectMixedDtype(yLocal, selMask, x1Local, x2Local, tmp3, tmp4, tmp5, count);
+    } else if constexpr (std::is_same_v<TX1, half> || std::is_same_v<TX1, float>) {
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
+        
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, count);
+        AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+    } else if constexpr (std::is_same_v<TX1, int8_t>) {
+        AscendC::LocalTensor<half> x1Half = tmp1.Get<half>();
+        AscendC::LocalTensor<half> x2Half = tmp2.Get<half>();
+        AscendC::LocalTensor<half> conditionLocal = tmp3.Get<half>();
+        AscendC::LocalTensor<half> yHalf = tmp4.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp5.Get<uint8_t>();
+        
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::Cast(x1Half, x1Local, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::Cast(x2Half, x2Local, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, count);
+        AscendC::Select(yHalf, selMask, x1Half, x2Half, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+        
+        AscendC::Cast(yLocal, yHalf, AscendC::RoundMode::CAST_NONE, count);
+    } else if constexpr (std::is_same_v<TX1, int32_t>) {
+        AscendC::LocalTensor<int32_t> conditionLocal = tmp1.Get<int32_t>();
+        AscendC::LocalTensor<int32_t> nonCondtionLocal = tmp2.Get<int32_t>();
+        AscendC::LocalTensor<half> tmp = tmp3.Get<half>();
+        
+        AscendC::Cast(tmp, _conditionLocal, AscendC::RoundMode::CAST_NONE, count);
+        AscendC::Cast(conditionLocal, tmp, AscendC::RoundMode::CAST_CEIL, count);
+        
+        AscendC::Duplicate(nonCondtionLocal, (int32_t)1, count);
+        AscendC::Sub(nonCondtionLocal, nonCondtionLocal, conditionLocal, count);
+        AscendC::Mul(conditionLocal, x1Local, conditionLocal, count);
+        AscendC::Mul(nonCondtionLocal, x2Local, nonCondtionLocal, count);
+        AscendC::Add(yLocal, conditionLocal, nonCondtionLocal, count);
+    }
+}
+
+// 融合尾处理，按 scale -> 加标量 -> 加张量 -> exp/relu 的固定顺序作用在yLocal上，和tiling里的定义一致
+constexpr uint8_t EPILOGUE_SCALE = 1;
+constexpr uint8_t EPILOGUE_ADD_SCALAR = 2;
+constexpr uint8_t EPILOGUE_ADD_TENSOR = 4;
+constexpr uint8_t EPILOGUE_EXP = 8;
+constexpr uint8_t EPILOGUE_RELU = 16;
+
+template <typename T>
+__aicore__ inline void ApplyEpilogue(const AscendC::LocalTensor<T>& yLocal, const AscendC::LocalTensor<T>& biasLocal,
+                                     uint8_t epilogueFlags, float epilogueScale, float epilogueAddScalar, uint32_t count)
+{
+    if (epilogueFlags & EPILOGUE_SCALE) {
+        AscendC::Muls(yLocal, yLocal, static_cast<T>(epilogueScale), count);
+    }
+    if (epilogueFlags & EPILOGUE_ADD_SCALAR) {
+        AscendC::Adds(yLocal, yLocal, static_cast<T>(epilogueAddScalar), count);
+    }
+    if (epilogueFlags & EPILOGUE_ADD_TENSOR) {
+        AscendC::Add(yLocal, yLocal, biasLocal, count);
+    }
+    if (epilogueFlags & EPILOGUE_EXP) {
+        AscendC::Exp(yLocal, yLocal, count);
+    } else if (epilogueFlags & EPILOGUE_RELU) {
+        AscendC::Relu(yLocal, yLocal, count);
+    }
+}
+
 class KernelSelectV2 {
 private:
     uint32_t tileDataNum; // 除了最后一次，tile里的数据数量
@@ -10,6 +164,10 @@ private:
     uint32_t tailDataNum; // 这个核最后一次计算的数据数量
     uint32_t processDataNum; // 这次要处理的数据数量
     
+    uint8_t epilogueFlags; // 融合尾处理，为0时不做
+    float epilogueScale;
+    float epilogueAddScalar;
+    
 public:
     __aicore__ inline KernelSelectV2() {}
     __aicore__ inline void Init(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR y, 
@@ -37,22 +195,17 @@ public:
         pipe->InitBuffer(inQueueX2, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_X2));
         pipe->InitBuffer(outQueueY, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
         
-        if constexpr (std::is_same_v<DTYPE_X1, half>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
-        } else if constexpr (std::is_same_v<DTYPE_X1, int8_t>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp3, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp4, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp5, this->tileDataNum * sizeof(uint8_t));
-        } else if constexpr (std::is_same_v<DTYPE_X1, int32_t>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(int32_t));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(int32_t));
-            pipe->InitBuffer(tmp3, this->tileDataNum * sizeof(half));
-        } else if constexpr (std::is_same_v<DTYPE_X1, float>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
+        InitSelectBuffers(pipe, tmp1, tmp2, tmp3, tmp4, tmp5, this->tileDataNum);
+    }
+    
+    __aicore__ inline void InitEpilogue(GM_ADDR bias, uint8_t epilogueFlags, float epilogueScale, float epilogueAddScalar)
+    {
+        this->epilogueFlags = epilogueFlags;
+        this->epilogueScale = epilogueScale;
+        this->epilogueAddScalar = epilogueAddScalar;
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            biasGm.SetGlobalBuffer((__gm__ DTYPE_Y *)bias, this->dataNum);
+            pipe->InitBuffer(inQueueBias, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
         }
     }
     
@@ -86,102 +239,45 @@ private:
         inQueueCondition.EnQue(conditionLocal);
         inQueueX1.EnQue(x1Local);
         inQueueX2.EnQue(x2Local);
+        
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            AscendC::LocalTensor<DTYPE_Y> biasLocal = inQueueBias.AllocTensor<DTYPE_Y>();
+            AscendC::DataCopy(biasLocal, biasGm[progress * this->tileDataNum], this->processDataNum);
+            inQueueBias.EnQue(biasLocal);
+        }
     }
     
     __aicore__ inline void Compute(int32_t progress)
     {
-        if constexpr (std::is_same_v<DTYPE_X1, half>) {
-            AscendC::LocalTensor<half> x1Local = inQueueX1.DeQue<half>();
-            AscendC::LocalTensor<half> x2Local = inQueueX2.DeQue<half>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<half> yLocal = outQueueY.AllocTensor<half>();
-            
-            AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            outQueueY.EnQue<half>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, int8_t>) {
-            AscendC::LocalTensor<int8_t> _x1Local = inQueueX1.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _x2Local = inQueueX2.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _yLocal = outQueueY.AllocTensor<int8_t>();
-            
-            AscendC::LocalTensor<half> x1Local = tmp1.Get<half>();
-            AscendC::LocalTensor<half> x2Local = tmp2.Get<half>();
-            AscendC::LocalTensor<half> conditionLocal = tmp3.Get<half>();
-            AscendC::LocalTensor<half> yLocal = tmp4.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp5.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(x1Local, _x1Local, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(x2Local, _x2Local, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            AscendC::Cast(_yLocal, yLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            
-            outQueueY.EnQue<int8_t>(_yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(_x1Local);
-            inQueueX2.FreeTensor(_x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, int32_t>) {
-            AscendC::LocalTensor<int32_t> x1Local = inQueueX1.DeQue<int32_t>();
-            AscendC::LocalTensor<int32_t> x2Local = inQueueX2.DeQue<int32_t>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<int32_t> yLocal = outQueueY.AllocTensor<int32_t>();
-            
-            AscendC::LocalTensor<int32_t> conditionLocal = tmp1.Get<int32_t>();
-            AscendC::LocalTensor<int32_t> nonCondtionLocal = tmp2.Get<int32_t>();
-            AscendC::LocalTensor<half> tmp = tmp3.Get<half>();
-            
-            AscendC::Cast(tmp, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(conditionLocal, tmp, AscendC::RoundMode::CAST_CEIL, this->processDataNum);
-            
-            AscendC::Duplicate(nonCondtionLocal, (int32_t)1, this->processDataNum);
-            AscendC::Sub(nonCondtionLocal, nonCondtionLocal, conditionLocal, this->processDataNum);
-            AscendC::Mul(x1Local, x1Local, conditionLocal, this->processDataNum); 
-            AscendC::Mul(x2Local, x2Local, nonCondtionLocal, this->processDataNum);
-            AscendC::Add(yLocal, x1Local, x2Local, this->processDataNum);
-            
-            outQueueY.EnQue<int32_t>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, float>) {
-            AscendC::LocalTensor<float> x1Local = inQueueX1.DeQue<float>();
-            AscendC::LocalTensor<float> x2Local = inQueueX2.DeQue<float>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<float> yLocal = outQueueY.AllocTensor<float>();
-            
-            AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            outQueueY.EnQue<float>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        }
-        else {
-            AscendC::LocalTensor<DTYPE_X1> x1Local = inQueueX1.DeQue<DTYPE_X1>();
-            AscendC::LocalTensor<DTYPE_X2> x2Local = inQueueX2.DeQue<DTYPE_X2>();
-            AscendC::LocalTensor<DTYPE_CONDITION> _conditionLocal = inQueueCondition.DeQue<DTYPE_CONDITION>();
-            AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
-            
-            outQueueY.EnQue<DTYPE_Y>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
+        AscendC::LocalTensor<DTYPE_X1> x1Local = inQueueX1.DeQue<DTYPE_X1>();
+        AscendC::LocalTensor<DTYPE_X2> x2Local = inQueueX2.DeQue<DTYPE_X2>();
+        AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
+        
+        SelectCompute(yLocal, _conditionLocal, x1Local, x2Local, tmp1, tmp2, tmp3, tmp4, tmp5, this->processDataNum);
+        
+        Epilogue(yLocal);
+        outQueueY.EnQue<DTYPE_Y>(yLocal);
+        inQueueCondition.FreeTensor(_conditionLocal);
+        inQueueX1.FreeTensor(x1Local);
+        inQueueX2.FreeTensor(x2Local);
+    }
+    
+    template <typename T>
+    __aicore__ inline void Epilogue(const AscendC::LocalTensor<T>& yLocal)
+    {
+        if constexpr (std::is_same_v<T, half> || std::is_same_v<T, float>) {
+            if (this->epilogueFlags == 0) {
+                return;
+            }
+            AscendC::LocalTensor<T> biasLocal;
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                biasLocal = inQueueBias.DeQue<T>();
+            }
+            ApplyEpilogue(yLocal, biasLocal, this->epilogueFlags, this->epilogueScale, this->epilogueAddScalar, this->processDataNum);
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                inQueueBias.FreeTensor(biasLocal);
+            }
         }
     }
     
@@ -197,6 +293,7 @@ private:
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX1;
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX2;
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueBias;
     AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueY;
     
     AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
@@ -208,6 +305,111 @@ private:
     AscendC::GlobalTensor<DTYPE_X1> x1Gm;
     AscendC::GlobalTensor<DTYPE_X2> x2Gm;
     AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> biasGm;
+    AscendC::GlobalTensor<DTYPE_Y> yGm;
+};
+
+// 小张量路径：整个张量一次搬进UB，单buffer、不走队列，只用flag在搬入、计算、搬出之间同步
+class KernelSelectV2Tiny {
+private:
+    uint32_t dataNum; // 要计算的数据数量，已按32个元素对齐
+    
+    uint8_t epilogueFlags; // 融合尾处理，为0时不做
+    float epilogueScale;
+    float epilogueAddScalar;
+    
+public:
+    __aicore__ inline KernelSelectV2Tiny() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR y, uint32_t smallDataNum, 
+                                AscendC::TPipe* pipeIn)
+    {
+        this->dataNum = smallDataNum;
+        
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition, this->dataNum);
+        x1Gm.SetGlobalBuffer((__gm__ DTYPE_X1 *)x1, this->dataNum);
+        x2Gm.SetGlobalBuffer((__gm__ DTYPE_X2 *)x2, this->dataNum);
+        yGm.SetGlobalBuffer((__gm__ DTYPE_Y *)y, this->dataNum);
+        
+        // UB只按实际数据量分配
+        pipe = pipeIn;
+        pipe->InitBuffer(conditionBuf, this->dataNum * sizeof(DTYPE_CONDITION));
+        pipe->InitBuffer(x1Buf, this->dataNum * sizeof(DTYPE_X1));
+        pipe->InitBuffer(x2Buf, this->dataNum * sizeof(DTYPE_X2));
+        pipe->InitBuffer(yBuf, this->dataNum * sizeof(DTYPE_Y));
+        InitSelectBuffers(pipe, tmp1, tmp2, tmp3, tmp4, tmp5, this->dataNum);
+    }
+    
+    __aicore__ inline void InitEpilogue(GM_ADDR bias, uint8_t epilogueFlags, float epilogueScale, float epilogueAddScalar)
+    {
+        this->epilogueFlags = epilogueFlags;
+        this->epilogueScale = epilogueScale;
+        this->epilogueAddScalar = epilogueAddScalar;
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            biasGm.SetGlobalBuffer((__gm__ DTYPE_Y *)bias, this->dataNum);
+            pipe->InitBuffer(biasBuf, this->dataNum * sizeof(DTYPE_Y));
+        }
+    }
+    
+    __aicore__ inline void Process()
+    {
+        AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = conditionBuf.Get<DTYPE_CONDITION>();
+        AscendC::LocalTensor<DTYPE_X1> x1Local = x1Buf.Get<DTYPE_X1>();
+        AscendC::LocalTensor<DTYPE_X2> x2Local = x2Buf.Get<DTYPE_X2>();
+        AscendC::LocalTensor<DTYPE_Y> yLocal = yBuf.Get<DTYPE_Y>();
+        
+        AscendC::DataCopy(conditionLocal, conditionGm, this->dataNum);
+        AscendC::DataCopy(x1Local, x1Gm, this->dataNum);
+        AscendC::DataCopy(x2Local, x2Gm, this->dataNum);
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            AscendC::DataCopy(biasBuf.Get<DTYPE_Y>(), biasGm, this->dataNum);
+        }
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::MTE2_V));
+        AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+        AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+        
+        SelectCompute(yLocal, conditionBuf.Get<int8_t>(), x1Local, x2Local, tmp1, tmp2, tmp3, tmp4, tmp5, this->dataNum);
+        Epilogue(yLocal);
+        
+        event_t eventIdVToMte3 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_MTE3));
+        AscendC::SetFlag<AscendC::HardEvent::V_MTE3>(eventIdVToMte3);
+        AscendC::WaitFlag<AscendC::HardEvent::V_MTE3>(eventIdVToMte3);
+        AscendC::DataCopy(yGm, yLocal, this->dataNum);
+    }
+    
+private:
+    template <typename T>
+    __aicore__ inline void Epilogue(const AscendC::LocalTensor<T>& yLocal)
+    {
+        if constexpr (std::is_same_v<T, half> || std::is_same_v<T, float>) {
+            if (this->epilogueFlags == 0) {
+                return;
+            }
+            AscendC::LocalTensor<T> biasLocal;
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                biasLocal = biasBuf.Get<T>();
+            }
+            ApplyEpilogue(yLocal, biasLocal, this->epilogueFlags, this->epilogueScale, this->epilogueAddScalar, this->dataNum);
+        }
+    }
+    
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> conditionBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> x1Buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> x2Buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> biasBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> yBuf;
+    
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp3;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp4;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp5;
+    
+    AscendC::GlobalTensor<DTYPE_X1> x1Gm;
+    AscendC::GlobalTensor<DTYPE_X2> x2Gm;
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> biasGm;
     AscendC::GlobalTensor<DTYPE_Y> yGm;
 };
 
@@ -218,6 +420,10 @@ private:
     uint32_t tileNum; // 这个核要计算的tile数量
     uint32_t tailDataNum; // 这个核最后一次计算的数据数量
     uint32_t processDataNum; // 这次要处理的数据数量
+    
+    uint8_t epilogueFlags; // 融合尾处理，为0时不做
+    float epilogueScale;
+    float epilogueAddScalar;
 private:
     uint16_t* yShape;
     uint8_t yDimNum;
@@ -226,9 +432,12 @@ private:
     uint8_t x1NeedBroadcast;
     uint8_t x2NeedBroadcast;
     
+    uint8_t biasNeedBroadcast;
+    
     uint32_t* condStrides;
     uint32_t* x1Strides;
     uint32_t* x2Strides;
+    uint32_t* biasStrides;
     uint32_t* yStrides;
     
 public:
@@ -261,23 +470,7 @@ public:
         pipe->InitBuffer(inQueueX2, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_X2));
         pipe->InitBuffer(outQueueY, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
         
-        if constexpr (std::is_same_v<DTYPE_X1, half>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
-        } else if constexpr (std::is_same_v<DTYPE_X1, int8_t>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp3, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp4, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp5, this->tileDataNum * sizeof(uint8_t));
-        } else if constexpr (std::is_same_v<DTYPE_X1, int32_t>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(int32_t));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(int32_t));
-            pipe->InitBuffer(tmp3, this->tileDataNum * sizeof(half));
-        } else if constexpr (std::is_same_v<DTYPE_X1, float>) {
-            pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
-            pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
-        }
+        InitSelectBuffers(pipe, tmp1, tmp2, tmp3, tmp4, tmp5, this->tileDataNum);
         
         // 广播相关参数
         this->yShape = yShape;
@@ -294,6 +487,20 @@ public:
         this->x2NeedBroadcast = x2NeedBroadcast;
 
     }
+    __aicore__ inline void InitEpilogue(GM_ADDR bias, uint8_t epilogueFlags, float epilogueScale, float epilogueAddScalar,
+                                        uint8_t biasNeedBroadcast, uint32_t* biasStrides)
+    {
+        this->epilogueFlags = epilogueFlags;
+        this->epilogueScale = epilogueScale;
+        this->epilogueAddScalar = epilogueAddScalar;
+        this->biasNeedBroadcast = biasNeedBroadcast;
+        this->biasStrides = biasStrides;
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            biasGm.SetGlobalBuffer((__gm__ DTYPE_Y *)bias, this->dataNum);
+            pipe->InitBuffer(inQueueBias, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
+        }
+    }
+    
     __aicore__ inline void Process()
     {
         uint32_t loopCount = this->tileNum;
@@ -322,6 +529,52 @@ private:
         return dstIndex;
     }
     
+    // 按广播关系逐个把输入搬进UB，偏移随y的下标递推，不用每个元素都重新做除法
+    template <typename T>
+    __aicore__ inline void CopyInBroadcast(AscendC::LocalTensor<T>& dstLocal, AscendC::GlobalTensor<T>& srcGm,
+                                           uint32_t* strides, uint32_t baseIndex)
+    {
+        uint32_t r[8] {};
+        uint32_t indices[8] {};
+        uint32_t currentOffset = 0;
+        
+        uint32_t n = baseIndex;
+        for (uint8_t i = 0; i < this->yDimNum; i++) {
+            if (strides[i] == 0) {
+                continue;
+            }
+            r[i] = n % yStrides[i];
+            indices[i] = n / yStrides[i] % yShape[i];
+            currentOffset += indices[i] * strides[i];
+        }
+        
+        dstLocal.SetValue(0, srcGm.GetValue(currentOffset));
+        
+        for (int i = 1; i < this->processDataNum; i++) {
+            for (uint8_t dim = 0; dim < this->yDimNum; dim++) {
+                const uint32_t& stride = strides[dim];
+                if (stride == 0) {
+                    continue;
+                }
+                uint32_t &rdim = r[dim];
+                if (rdim + 1 == yStrides[dim]) {
+                    rdim = 0;
+                    uint32_t &indice = indices[dim];
+                    if (indice + 1 == yShape[dim]) {
+                        currentOffset -= indice * stride;
+                        indice = 0;
+                    } else {
+                        currentOffset += stride;
+                        indice += 1;
+                    }
+                } else {
+                    ++rdim;
+                }
+            }
+            dstLocal.SetValue(i, srcGm.GetValue(currentOffset));
+        }
+    }
+    
     __aicore__ inline void CopyIn(int32_t progress)
     {
         AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = inQueueCondition.AllocTensor<DTYPE_CONDITION>();
@@ -331,131 +584,19 @@ private:
         int32_t baseIndex = progress * this->tileDataNum;
         
         if (this->condNeedBroadcast) {
-            uint32_t condIndex = 0;
-            uint32_t r[8] {};
-            uint32_t indices[8] {};
-            uint32_t currentOffset = 0;
-            
-            uint32_t n = baseIndex;
-            for (uint8_t i = 0; i < this->yDimNum; i++) {
-                r[i] = n % yStrides[i];
-                indices[i] = n / yStrides[i] % yShape[i];
-                currentOffset += indices[i] * condStrides[i];
-            }
-            
-            conditionLocal.SetValue(0, conditionGm.GetValue(currentOffset));
-            
-            for (int i = 1; i < this->processDataNum; i++) {
-                n += 1;
-                for (uint8_t dim = 0; dim < this->yDimNum; dim++) {
-                    const uint32_t& stride = condStrides[dim];
-                    if (stride == 0) {
-                        continue;
-                    }
-                    uint32_t &rdim = r[dim];
-                    if (rdim + 1 == yStrides[dim]) {
-                        rdim = 0;
-                        uint32_t &indice = indices[dim];
-                        if (indice + 1 == yShape[dim]) {
-                            currentOffset -= indice * stride;
-                            indice = 0;
-                        } else {
-                            currentOffset += stride;
-                            indice += 1;
-                        }
-                    } else {
-                        ++rdim;
-                    }
-                }
-                conditionLocal.SetValue(i, conditionGm.GetValue(currentOffset));
-            }
+            CopyInBroadcast(conditionLocal, conditionGm, condStrides, baseIndex);
         } else {
             AscendC::DataCopy(conditionLocal, conditionGm[progress * this->tileDataNum], this->processDataNum);
         }
-
+        
         if (this->x1NeedBroadcast) {
-            uint32_t x1Index = 0;
-            uint32_t r[8] {};
-            uint32_t indices[8] {};
-            uint32_t currentOffset = 0;
-            
-            uint32_t n = baseIndex;
-            for (uint8_t i = 0; i < this->yDimNum; i++) {
-                r[i] = n % yStrides[i];
-                indices[i] = n / yStrides[i] % yShape[i];
-                currentOffset += indices[i] * x1Strides[i];
-            }
-            
-            x1Local.SetValue(0, x1Gm.GetValue(currentOffset));
-            
-            for (int i = 1; i < this->processDataNum; i++) {
-                n += 1;
-                for (uint8_t dim = 0; dim < this->yDimNum; dim++) {
-                    const uint32_t& stride = x1Strides[dim];
-                    if (stride == 0) {
-                        continue;
-                    }
-                    uint32_t &rdim = r[dim];
-                    if (rdim + 1 == yStrides[dim]) {
-                        rdim = 0;
-                        uint32_t &indice = indices[dim];
-                        if (indice + 1 == yShape[dim]) {
-                            currentOffset -= indice * stride;
-                            indice = 0;
-                        } else {
-                            currentOffset += stride;
-                            indice += 1;
-                        }
-                    } else {
-                        ++rdim;
-                    }
-                }
-                x1Local.SetValue(i, x1Gm.GetValue(currentOffset));
-            }
-            
+            CopyInBroadcast(x1Local, x1Gm, x1Strides, baseIndex);
         } else {
             AscendC::DataCopy(x1Local, x1Gm[progress * this->tileDataNum], this->processDataNum);
         }
         
         if (this->x2NeedBroadcast) {
-            uint32_t x2Index = 0;
-            uint32_t r[8] {};
-            uint32_t indices[8] {};
-            uint32_t currentOffset = 0;
-            
-            uint32_t n = baseIndex;
-            for (uint8_t i = 0; i < this->yDimNum; i++) {
-                r[i] = n % yStrides[i];
-                indices[i] = n / yStrides[i] % yShape[i];
-                currentOffset += indices[i] * x2Strides[i];
-            }
-            
-            x2Local.SetValue(0, x2Gm.GetValue(currentOffset));
-            
-            for (int i = 1; i < this->processDataNum; i++) {
-                n += 1;
-                for (uint8_t dim = 0; dim < this->yDimNum; dim++) {
-                    const uint32_t& stride = x2Strides[dim];
-                    if (stride == 0) {
-                        continue;
-                    }
-                    uint32_t &rdim = r[dim];
-                    if (rdim + 1 == yStrides[dim]) {
-                        rdim = 0;
-                        uint32_t &indice = indices[dim];
-                        if (indice + 1 == yShape[dim]) {
-                            currentOffset -= indice * stride;
-                            indice = 0;
-                        } else {
-                            currentOffset += stride;
-                            indice += 1;
-                        }
-                    } else {
-                        ++rdim;
-                    }
-                }
-                x2Local.SetValue(i, x2Gm.GetValue(currentOffset));
-            }
+            CopyInBroadcast(x2Local, x2Gm, x2Strides, baseIndex);
         } else {
             AscendC::DataCopy(x2Local, x2Gm[progress * this->tileDataNum], this->processDataNum);
         }
@@ -463,102 +604,49 @@ private:
         inQueueCondition.EnQue(conditionLocal);
         inQueueX1.EnQue(x1Local);
         inQueueX2.EnQue(x2Local);
+        
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            AscendC::LocalTensor<DTYPE_Y> biasLocal = inQueueBias.AllocTensor<DTYPE_Y>();
+            if (this->biasNeedBroadcast) {
+                CopyInBroadcast(biasLocal, biasGm, biasStrides, baseIndex);
+            } else {
+                AscendC::DataCopy(biasLocal, biasGm[progress * this->tileDataNum], this->processDataNum);
+            }
+            inQueueBias.EnQue(biasLocal);
+        }
     }
     
     __aicore__ inline void Compute(int32_t progress)
     {
-        if constexpr (std::is_same_v<DTYPE_X1, half>) {
-            AscendC::LocalTensor<half> x1Local = inQueueX1.DeQue<half>();
-            AscendC::LocalTensor<half> x2Local = inQueueX2.DeQue<half>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<half> yLocal = outQueueY.AllocTensor<half>();
-            
-            AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            outQueueY.EnQue<half>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, int8_t>) {
-            AscendC::LocalTensor<int8_t> _x1Local = inQueueX1.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _x2Local = inQueueX2.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<int8_t> _yLocal = outQueueY.AllocTensor<int8_t>();
-            
-            AscendC::LocalTensor<half> x1Local = tmp1.Get<half>();
-            AscendC::LocalTensor<half> x2Local = tmp2.Get<half>();
-            AscendC::LocalTensor<half> conditionLocal = tmp3.Get<half>();
-            AscendC::LocalTensor<half> yLocal = tmp4.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp5.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(x1Local, _x1Local, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(x2Local, _x2Local, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            AscendC::Cast(_yLocal, yLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            
-            outQueueY.EnQue<int8_t>(_yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(_x1Local);
-            inQueueX2.FreeTensor(_x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, int32_t>) {
-            AscendC::LocalTensor<int32_t> x1Local = inQueueX1.DeQue<int32_t>();
-            AscendC::LocalTensor<int32_t> x2Local = inQueueX2.DeQue<int32_t>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<int32_t> yLocal = outQueueY.AllocTensor<int32_t>();
-            
-            AscendC::LocalTensor<int32_t> conditionLocal = tmp1.Get<int32_t>();
-            AscendC::LocalTensor<int32_t> nonCondtionLocal = tmp2.Get<int32_t>();
-            AscendC::LocalTensor<half> tmp = tmp3.Get<half>();
-            
-            AscendC::Cast(tmp, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::Cast(conditionLocal, tmp, AscendC::RoundMode::CAST_CEIL, this->processDataNum);
-            
-            AscendC::Duplicate(nonCondtionLocal, (int32_t)1, this->processDataNum);
-            AscendC::Sub(nonCondtionLocal, nonCondtionLocal, conditionLocal, this->processDataNum);
-            AscendC::Mul(x1Local, x1Local, conditionLocal, this->processDataNum); 
-            AscendC::Mul(x2Local, x2Local, nonCondtionLocal, this->processDataNum);
-            AscendC::Add(yLocal, x1Local, x2Local, this->processDataNum);
-            
-            outQueueY.EnQue<int32_t>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        } else if constexpr (std::is_same_v<DTYPE_X1, float>) {
-            AscendC::LocalTensor<float> x1Local = inQueueX1.DeQue<float>();
-            AscendC::LocalTensor<float> x2Local = inQueueX2.DeQue<float>();
-            AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
-            AscendC::LocalTensor<float> yLocal = outQueueY.AllocTensor<float>();
-            
-            AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
-            AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
-            
-            AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->processDataNum);
-            AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->processDataNum);
-            AscendC::Select(yLocal, selMask, x1Local, x2Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
-            
-            outQueueY.EnQue<float>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
-        }
-        else {
-            AscendC::LocalTensor<DTYPE_X1> x1Local = inQueueX1.DeQue<DTYPE_X1>();
-            AscendC::LocalTensor<DTYPE_X2> x2Local = inQueueX2.DeQue<DTYPE_X2>();
-            AscendC::LocalTensor<DTYPE_CONDITION> _conditionLocal = inQueueCondition.DeQue<DTYPE_CONDITION>();
-            AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
-            
-            outQueueY.EnQue<DTYPE_Y>(yLocal);
-            inQueueCondition.FreeTensor(_conditionLocal);
-            inQueueX1.FreeTensor(x1Local);
-            inQueueX2.FreeTensor(x2Local);
+        AscendC::LocalTensor<DTYPE_X1> x1Local = inQueueX1.DeQue<DTYPE_X1>();
+        AscendC::LocalTensor<DTYPE_X2> x2Local = inQueueX2.DeQue<DTYPE_X2>();
+        AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
+        
+        SelectCompute(yLocal, _conditionLocal, x1Local, x2Local, tmp1, tmp2, tmp3, tmp4, tmp5, this->processDataNum);
+        
+        Epilogue(yLocal);
+        outQueueY.EnQue<DTYPE_Y>(yLocal);
+        inQueueCondition.FreeTensor(_conditionLocal);
+        inQueueX1.FreeTensor(x1Local);
+        inQueueX2.FreeTensor(x2Local);
+    }
+    
+    template <typename T>
+    __aicore__ inline void Epilogue(const AscendC::LocalTensor<T>& yLocal)
+    {
+        if constexpr (std::is_same_v<T, half> || std::is_same_v<T, float>) {
+            if (this->epilogueFlags == 0) {
+                return;
+            }
+            AscendC::LocalTensor<T> biasLocal;
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                biasLocal = inQueueBias.DeQue<T>();
+            }
+            ApplyEpilogue(yLocal, biasLocal, this->epilogueFlags, this->epilogueScale, this->epilogueAddScalar, this->processDataNum);
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                inQueueBias.FreeTensor(biasLocal);
+            }
         }
     }
     
@@ -574,8 +662,392 @@ private:
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX1;
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX2;
     AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueBias;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueY;
+    
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp3;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp4;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp5;
+    
+    AscendC::GlobalTensor<DTYPE_X1> x1Gm;
+    AscendC::GlobalTensor<DTYPE_X2> x2Gm;
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> biasGm;
+    AscendC::GlobalTensor<DTYPE_Y> yGm;
+};
+
+// 外轴/内轴广播的专用路径：y看成[outerNum, innerNum]，按每个输入在两段上是否广播分四类
+// ROW（如[1,S]）每个列块只搬一次，在UB里复制成tileRowNum行常驻；COL（如[N,1]）每个tile把这几行的值整块搬进来再展开；
+// SCALAR开始时填满一次；只有FULL走队列按tile搬运。tile内的数据在GM上总是连续的，不再逐元素搬运
+constexpr uint8_t OPERAND_FULL = 0;
+constexpr uint8_t OPERAND_ROW = 1;
+constexpr uint8_t OPERAND_COL = 2;
+constexpr uint8_t OPERAND_SCALAR = 3;
+
+// Duplicate不支持1字节类型，按uint16两个一组填充，count是32的倍数
+template <typename T>
+__aicore__ inline void DuplicateValue(const AscendC::LocalTensor<T>& dstLocal, T value, uint32_t count)
+{
+    if constexpr (sizeof(T) == 1) {
+        uint16_t byte = static_cast<uint8_t>(value);
+        AscendC::Duplicate(dstLocal.template ReinterpretCast<uint16_t>(), static_cast<uint16_t>(byte | (byte << 8)), count / 2);
+    } else {
+        AscendC::Duplicate(dstLocal, value, count);
+    }
+}
+
+constexpr uint32_t COL_ALIGN_NUM = 32;      // COL输入按32个元素对齐搬入，1字节类型也是整block
+constexpr uint32_t COL_TAIL_BYTES = 512;    // 不满8行的Brcb结果暂存，最多两个repeat
+constexpr uint32_t MAX_COPY_REPEAT = 255;
+
+// src里rowNum个值，第i个铺满dst的第i行（rowLen个元素，整block）。U只能是2、4字节类型，Brcb和Copy不支持1字节
+template <typename U>
+__aicore__ inline void BroadcastColumn(const AscendC::LocalTensor<U>& dstLocal, const AscendC::LocalTensor<U>& srcLocal,
+                                       const AscendC::LocalTensor<U>& tailLocal, uint32_t rowNum, uint32_t rowLen)
+{
+    constexpr uint32_t blockNum = 32 / sizeof(U);
+    uint16_t rowBlockNum = static_cast<uint16_t>(rowLen / blockNum);
+    // 1. Brcb每个repeat把8个值各扩成一个block，block间隔设成一行，直接落到各行行首
+    uint32_t groupRowNum = rowNum / 8 * 8;
+    if (groupRowNum > 0) {
+        AscendC::Brcb(dstLocal, srcLocal, static_cast<uint8_t>(groupRowNum / 8),
+                      {rowBlockNum, static_cast<uint16_t>(8 * rowBlockNum)});
+    }
+    if (groupRowNum < rowNum) {
+        // 剩下不满8行，直接写会越过最后一行，先扩到tailLocal（src起点要32字节对齐），再逐块搬到行首
+        uint32_t tailStart = groupRowNum / blockNum * blockNum;
+        AscendC::Brcb(tailLocal, srcLocal[tailStart], static_cast<uint8_t>((rowNum - tailStart + 7) / 8), {1, 8});
+        AscendC::PipeBarrier<PIPE_V>();
+        AscendC::Copy(dstLocal[groupRowNum * rowLen], tailLocal[(groupRowNum - tailStart) * blockNum], blockNum,
+                      static_cast<uint8_t>(rowNum - groupRowNum), {1, 1, rowBlockNum, 1});
+    }
+    AscendC::PipeBarrier<PIPE_V>();
+    // 2. 每行从行首block铺满，源block间隔为0，每条指令写各行的8个block
+    for (uint32_t rowStart = 0; rowStart < rowNum; rowStart += MAX_COPY_REPEAT) {
+        uint8_t repeat = static_cast<uint8_t>(rowNum - rowStart < MAX_COPY_REPEAT ? rowNum - rowStart : MAX_COPY_REPEAT);
+        uint32_t rowOffset = rowStart * rowLen;
+        for (uint32_t block = 1; block < rowBlockNum; block += 8) {
+            uint64_t mask = (rowBlockNum - block < 8 ? rowBlockNum - block : 8) * blockNum;
+            AscendC::Copy(dstLocal[rowOffset + block * blockNum], dstLocal[rowOffset], mask, repeat,
+                          {1, 0, rowBlockNum, rowBlockNum});
+        }
+    }
+    AscendC::PipeBarrier<PIPE_V>();
+}
+
+// COL输入的展开：loadLocal里是搬进来的rowNum个值，dst每行colNum个。1字节类型先把每个值拼成uint16的两个字节，
+// 按uint16展开后逐字节也是同一个值；workLocal至少4*COL_ALIGN_NUM对齐后的行数字节
+template <typename T>
+__aicore__ inline void ExpandColumn(const AscendC::LocalTensor<T>& dstLocal, const AscendC::LocalTensor<T>& loadLocal,
+                                    const AscendC::LocalTensor<uint8_t>& workLocal, const AscendC::LocalTensor<uint8_t>& tailLocal,
+                                    uint32_t rowNum, uint32_t colNum)
+{
+    if constexpr (sizeof(T) == 1) {
+        uint32_t alignRowNum = (rowNum + COL_ALIGN_NUM - 1) / COL_ALIGN_NUM * COL_ALIGN_NUM;
+        AscendC::LocalTensor<half> halfLocal = workLocal.ReinterpretCast<half>();
+        AscendC::LocalTensor<uint16_t> shiftLocal = workLocal.ReinterpretCast<uint16_t>();
+        AscendC::LocalTensor<uint16_t> packedLocal = workLocal[alignRowNum * sizeof(half)].ReinterpretCast<uint16_t>();
+        AscendC::Cast(halfLocal, loadLocal.template ReinterpretCast<uint8_t>(), AscendC::RoundMode::CAST_NONE, alignRowNum);
+        AscendC::PipeBarrier<PIPE_V>();
+        AscendC::Cast(packedLocal.ReinterpretCast<int16_t>(), halfLocal, AscendC::RoundMode::CAST_RINT, alignRowNum);
+        AscendC::PipeBarrier<PIPE_V>();
+        AscendC::ShiftLeft(shiftLocal, packedLocal, static_cast<uint16_t>(8), alignRowNum);
+        AscendC::PipeBarrier<PIPE_V>();
+        AscendC::Or(packedLocal, packedLocal, shiftLocal, alignRowNum);
+        AscendC::PipeBarrier<PIPE_V>();
+        BroadcastColumn(dstLocal.template ReinterpretCast<uint16_t>(), packedLocal, tailLocal.ReinterpretCast<uint16_t>(),
+                        rowNum, colNum / 2);
+    } else {
+        using U = std::conditional_t<sizeof(T) == 2, uint16_t, uint32_t>;
+        BroadcastColumn(dstLocal.template ReinterpretCast<U>(), loadLocal.template ReinterpretCast<U>(),
+                        tailLocal.ReinterpretCast<U>(), rowNum, colNum);
+    }
+}
+
+class KernelSelectV2TileReuse {
+private:
+    uint32_t tileDataNum; // tile里最多的数据数量
+    uint32_t processDataNum; // 这次要处理的数据数量
+    
+    uint8_t epilogueFlags; // 融合尾处理，为0时不做
+    float epilogueScale;
+    float epilogueAddScalar;
+private:
+    uint32_t outerNum; // y的外轴长度（行数）
+    uint32_t innerNum; // y的内轴长度（列数）
+    uint32_t tileRowNum; // 一个tile里的行数
+    uint32_t tileColNum; // 一个tile里的列数
+    uint32_t rowNum; // 这次要处理的行数
+    uint32_t colNum; // 这次要处理的列数
+    
+    uint8_t condMode;
+    uint8_t x1Mode;
+    uint8_t x2Mode;
+    uint32_t colAlignNum; // COL输入一个tile的行数，按COL_ALIGN_NUM对齐
+    
+    // colBuf按对齐后的行数划分：搬入区4字节、1字节类型拼值用的临时区4字节，后面是Brcb尾部暂存
+    static constexpr uint32_t COL_BUF_RATE = 8;
+    
+public:
+    __aicore__ inline KernelSelectV2TileReuse() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR y, uint32_t tileDataNum, 
+                                uint32_t outerNum, uint32_t innerNum, uint32_t tileRowNum, uint32_t tileColNum, 
+                                uint8_t condMode, uint8_t x1Mode, uint8_t x2Mode, 
+                                AscendC::TPipe* pipeIn)
+    {
+        uint32_t blockNum = AscendC::GetBlockNum();
+        ASSERT(blockNum != 0 && "GetBlockNum() is 0");
+        
+        this->tileDataNum = tileDataNum;
+        this->outerNum = outerNum;
+        this->innerNum = innerNum;
+        this->tileRowNum = tileRowNum;
+        this->tileColNum = tileColNum;
+        this->condMode = condMode;
+        this->x1Mode = x1Mode;
+        this->x2Mode = x2Mode;
+        
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition, OperandDataNum(this->condMode));
+        x1Gm.SetGlobalBuffer((__gm__ DTYPE_X1 *)x1, OperandDataNum(this->x1Mode));
+        x2Gm.SetGlobalBuffer((__gm__ DTYPE_X2 *)x2, OperandDataNum(this->x2Mode));
+        yGm.SetGlobalBuffer((__gm__ DTYPE_Y *)y, this->outerNum * this->innerNum);
+        
+        pipe = pipeIn;
+        InitOperand(inQueueCondition, condBuf, conditionGm, this->condMode);
+        InitOperand(inQueueX1, x1Buf, x1Gm, this->x1Mode);
+        InitOperand(inQueueX2, x2Buf, x2Gm, this->x2Mode);
+        pipe->InitBuffer(outQueueY, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
+        // COL输入的搬入区和展开用的临时空间，几个COL输入依次使用；比省下的第二块buffer小得多
+        if (this->condMode == OPERAND_COL || this->x1Mode == OPERAND_COL || this->x2Mode == OPERAND_COL) {
+            this->colAlignNum = (this->tileRowNum + COL_ALIGN_NUM - 1) / COL_ALIGN_NUM * COL_ALIGN_NUM;
+            pipe->InitBuffer(colBuf, this->colAlignNum * COL_BUF_RATE + COL_TAIL_BYTES);
+        }
+        
+        InitSelectBuffers(pipe, tmp1, tmp2, tmp3, tmp4, tmp5, this->tileDataNum);
+    }
+    
+    // bias只支持和y同shape
+    __aicore__ inline void InitEpilogue(GM_ADDR bias, uint8_t epilogueFlags, float epilogueScale, float epilogueAddScalar)
+    {
+        this->epilogueFlags = epilogueFlags;
+        this->epilogueScale = epilogueScale;
+        this->epilogueAddScalar = epilogueAddScalar;
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            biasGm.SetGlobalBuffer((__gm__ DTYPE_Y *)bias, this->outerNum * this->innerNum);
+            pipe->InitBuffer(inQueueBias, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
+        }
+    }
+    
+    __aicore__ inline void Process()
+    {
+        // 外层按列块、内层按行块，ROW类输入在一个列块内一直复用
+        for (uint32_t colStart = 0; colStart < this->innerNum; colStart += this->tileColNum) {
+            this->colNum = this->innerNum - colStart < this->tileColNum ? this->innerNum - colStart : this->tileColNum;
+            LoadRowOperands(colStart);
+            for (uint32_t rowStart = 0; rowStart < this->outerNum; rowStart += this->tileRowNum) {
+                this->rowNum = this->outerNum - rowStart < this->tileRowNum ? this->outerNum - rowStart : this->tileRowNum;
+                this->processDataNum = this->rowNum * this->colNum;
+                uint32_t offset = rowStart * this->innerNum + colStart;
+                CopyIn(offset, rowStart);
+                Compute();
+                CopyOut(offset);
+            }
+        }
+    }
+    
+private:
+    __aicore__ inline uint32_t OperandDataNum(uint8_t mode)
+    {
+        if (mode == OPERAND_ROW) {
+            return this->innerNum;
+        } else if (mode == OPERAND_COL) {
+            return this->outerNum;
+        } else if (mode == OPERAND_SCALAR) {
+            return 1;
+        }
+        return this->outerNum * this->innerNum;
+    }
+    
+    // FULL走double buffer队列，其余常驻一块UB，SCALAR在这里直接填满
+    template <typename T>
+    __aicore__ inline void InitOperand(AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM>& que, 
+                                       AscendC::TBuf<AscendC::TPosition::VECCALC>& buf, 
+                                       AscendC::GlobalTensor<T>& srcGm, uint8_t mode)
+    {
+        if (mode == OPERAND_FULL) {
+            pipe->InitBuffer(que, BUFFER_NUM, this->tileDataNum * sizeof(T));
+            return;
+        }
+        pipe->InitBuffer(buf, this->tileDataNum * sizeof(T));
+        if (mode == OPERAND_SCALAR) {
+            DuplicateValue(buf.Get<T>(), srcGm.GetValue(0), this->tileDataNum);
+        }
+    }
+    
+    template <typename T>
+    __aicore__ inline void CopyInRowOperand(AscendC::TBuf<AscendC::TPosition::VECCALC>& buf, 
+                                            AscendC::GlobalTensor<T>& srcGm, uint8_t mode, uint32_t colStart)
+    {
+        if (mode == OPERAND_ROW) {
+            AscendC::DataCopy(buf.Get<T>(), srcGm[colStart], this->colNum);
+        }
+    }
+    
+    // 按倍增把第一行复制到tileRowNum行，UB内搬运走vector流水，每一步都读上一步写的数据
+    template <typename T>
+    __aicore__ inline void FillRowOperand(AscendC::TBuf<AscendC::TPosition::VECCALC>& buf, uint8_t mode)
+    {
+        if (mode != OPERAND_ROW) {
+            return;
+        }
+        AscendC::LocalTensor<T> dstLocal = buf.Get<T>();
+        uint32_t filledNum = this->colNum;
+        uint32_t totalNum = this->tileRowNum * this->colNum;
+        while (filledNum < totalNum) {
+            uint32_t copyNum = totalNum - filledNum < filledNum ? totalNum - filledNum : filledNum;
+            AscendC::DataCopy(dstLocal[filledNum], dstLocal, copyNum);
+            AscendC::PipeBarrier<PIPE_V>();
+            filledNum += copyNum;
+        }
+    }
+    
+    __aicore__ inline void LoadRowOperands(uint32_t colStart)
+    {
+        if (this->condMode != OPERAND_ROW && this->x1Mode != OPERAND_ROW && this->x2Mode != OPERAND_ROW) {
+            return;
+        }
+        // 常驻区会被覆盖，先等上一个列块的计算读完
+        event_t eventIdVToMte2 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_MTE2));
+        AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+        AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+        CopyInRowOperand(condBuf, conditionGm, this->condMode, colStart);
+        CopyInRowOperand(x1Buf, x1Gm, this->x1Mode, colStart);
+        CopyInRowOperand(x2Buf, x2Gm, this->x2Mode, colStart);
+        event_t eventIdMte2ToV = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::MTE2_V));
+        AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+        AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+        FillRowOperand<DTYPE_CONDITION>(condBuf, this->condMode);
+        FillRowOperand<DTYPE_X1>(x1Buf, this->x1Mode);
+        FillRowOperand<DTYPE_X2>(x2Buf, this->x2Mode);
+    }
+    
+    template <typename T>
+    __aicore__ inline void CopyInOperand(AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM>& que, 
+                                         AscendC::TBuf<AscendC::TPosition::VECCALC>& buf, 
+                                         AscendC::GlobalTensor<T>& srcGm, uint8_t mode, uint32_t offset, uint32_t rowStart)
+    {
+        if (mode == OPERAND_FULL) {
+            AscendC::LocalTensor<T> dstLocal = que.AllocTensor<T>();
+            AscendC::DataCopy(dstLocal, srcGm[offset], this->processDataNum);
+            que.EnQue(dstLocal);
+        } else if (mode == OPERAND_COL) {
+            // 这几行的值整块搬进来一次（按32个元素对齐，最后一个tile会多读几个不用的值），再在UB里展开；
+            // 搬入区可能还在被上一个COL输入的展开读
+            AscendC::LocalTensor<T> loadLocal = colBuf.GetWithOffset<T>(this->colAlignNum, 0);
+            event_t eventIdVToMte2 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_MTE2));
+            AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+            AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+            AscendC::DataCopy(loadLocal, srcGm[rowStart], (this->rowNum + COL_ALIGN_NUM - 1) / COL_ALIGN_NUM * COL_ALIGN_NUM);
+            event_t eventIdMte2ToV = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::MTE2_V));
+            AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+            AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+            // 上一个tile的计算还在读常驻区
+            AscendC::PipeBarrier<PIPE_V>();
+            uint32_t workOffset = this->colAlignNum * sizeof(uint32_t);
+            ExpandColumn(buf.Get<T>(), loadLocal, colBuf.GetWithOffset<uint8_t>(workOffset, workOffset),
+                         colBuf.GetWithOffset<uint8_t>(COL_TAIL_BYTES, this->colAlignNum * COL_BUF_RATE),
+                         this->rowNum, this->colNum);
+        }
+    }
+    
+    template <typename T>
+    __aicore__ inline AscendC::LocalTensor<T> FetchOperand(AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM>& que, 
+                                                          AscendC::TBuf<AscendC::TPosition::VECCALC>& buf, uint8_t mode)
+    {
+        if (mode == OPERAND_FULL) {
+            return que.DeQue<T>();
+        }
+        return buf.Get<T>();
+    }
+    
+    template <typename T>
+    __aicore__ inline void ReleaseOperand(AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM>& que, 
+                                          AscendC::LocalTensor<T>& local, uint8_t mode)
+    {
+        if (mode == OPERAND_FULL) {
+            que.FreeTensor(local);
+        }
+    }
+    
+    __aicore__ inline void CopyIn(uint32_t offset, uint32_t rowStart)
+    {
+        CopyInOperand(inQueueCondition, condBuf, conditionGm, this->condMode, offset, rowStart);
+        CopyInOperand(inQueueX1, x1Buf, x1Gm, this->x1Mode, offset, rowStart);
+        CopyInOperand(inQueueX2, x2Buf, x2Gm, this->x2Mode, offset, rowStart);
+        
+        if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+            AscendC::LocalTensor<DTYPE_Y> biasLocal = inQueueBias.AllocTensor<DTYPE_Y>();
+            AscendC::DataCopy(biasLocal, biasGm[offset], this->processDataNum);
+            inQueueBias.EnQue(biasLocal);
+        }
+    }
+    
+    __aicore__ inline void Compute()
+    {
+        AscendC::LocalTensor<DTYPE_X1> x1Local = FetchOperand<DTYPE_X1>(inQueueX1, x1Buf, this->x1Mode);
+        AscendC::LocalTensor<DTYPE_X2> x2Local = FetchOperand<DTYPE_X2>(inQueueX2, x2Buf, this->x2Mode);
+        AscendC::LocalTensor<int8_t> _conditionLocal = FetchOperand<int8_t>(inQueueCondition, condBuf, this->condMode);
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.AllocTensor<DTYPE_Y>();
+        
+        SelectCompute(yLocal, _conditionLocal, x1Local, x2Local, tmp1, tmp2, tmp3, tmp4, tmp5, this->processDataNum);
+        
+        Epilogue(yLocal);
+        outQueueY.EnQue<DTYPE_Y>(yLocal);
+        ReleaseOperand(inQueueCondition, _conditionLocal, this->condMode);
+        ReleaseOperand(inQueueX1, x1Local, this->x1Mode);
+        ReleaseOperand(inQueueX2, x2Local, this->x2Mode);
+    }
+    
+    template <typename T>
+    __aicore__ inline void Epilogue(const AscendC::LocalTensor<T>& yLocal)
+    {
+        if constexpr (std::is_same_v<T, half> || std::is_same_v<T, float>) {
+            if (this->epilogueFlags == 0) {
+                return;
+            }
+            AscendC::LocalTensor<T> biasLocal;
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                biasLocal = inQueueBias.DeQue<T>();
+            }
+            ApplyEpilogue(yLocal, biasLocal, this->epilogueFlags, this->epilogueScale, this->epilogueAddScalar, this->processDataNum);
+            if (this->epilogueFlags & EPILOGUE_ADD_TENSOR) {
+                inQueueBias.FreeTensor(biasLocal);
+            }
+        }
+    }
+    
+    __aicore__ inline void CopyOut(uint32_t offset)
+    {
+        AscendC::LocalTensor<DTYPE_Y> yLocal = outQueueY.DeQue<DTYPE_Y>();
+        AscendC::DataCopy(yGm[offset], yLocal, this->processDataNum);
+        outQueueY.FreeTensor(yLocal);
+    }
+    
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX1;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueX2;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueBias;
     AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueY;
     
+    AscendC::TBuf<AscendC::TPosition::VECCALC> condBuf; // 非FULL的输入常驻UB
+    AscendC::TBuf<AscendC::TPosition::VECCALC> x1Buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> x2Buf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> colBuf; // COL输入的搬入区和展开用的临时空间
+    
     AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
     AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
     AscendC::TBuf<AscendC::TPosition::VECCALC> tmp3;
@@ -585,14 +1057,110 @@ private:
     AscendC::GlobalTensor<DTYPE_X1> x1Gm;
     AscendC::GlobalTensor<DTYPE_X2> x2Gm;
     AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> biasGm;
     AscendC::GlobalTensor<DTYPE_Y> yGm;
 };
 
-extern "C" __global__ __aicore__ void select_v2(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR y, GM_ADDR workspace, GM_ADDR tiling) {
+// tf Select按行选择：condition [N] 决定y的每一行整块取自x1还是x2，只搬运不计算
+// 相邻且condition相同的行在GM上是连续的，合并成一段按tile搬运
+class KernelSelectV2RowCopy {
+private:
+    uint32_t tileDataNum; // 一次搬运的最大数据数量
+    uint32_t rowNum; // y第0维的长度
+    uint32_t rowDataNum; // 每行的元素个数
+    
+public:
+    __aicore__ inline KernelSelectV2RowCopy() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR y, uint32_t tileDataNum, 
+                                uint32_t rowNum, uint32_t rowDataNum, AscendC::TPipe* pipeIn)
+    {
+        this->tileDataNum = tileDataNum;
+        this->rowNum = rowNum;
+        this->rowDataNum = rowDataNum;
+        
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition, this->rowNum);
+        x1Gm.SetGlobalBuffer((__gm__ DTYPE_Y *)x1, this->rowNum * this->rowDataNum);
+        x2Gm.SetGlobalBuffer((__gm__ DTYPE_Y *)x2, this->rowNum * this->rowDataNum);
+        yGm.SetGlobalBuffer((__gm__ DTYPE_Y *)y, this->rowNum * this->rowDataNum);
+        
+        pipe = pipeIn;
+        pipe->InitBuffer(queBind, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_Y));
+    }
+    
+    __aicore__ inline void Process()
+    {
+        uint32_t rowStart = 0;
+        while (rowStart < this->rowNum) {
+            bool cond = conditionGm.GetValue(rowStart);
+            uint32_t rowEnd = rowStart + 1;
+            while (rowEnd < this->rowNum && static_cast<bool>(conditionGm.GetValue(rowEnd)) == cond) {
+                rowEnd++;
+            }
+            CopyRows(cond ? x1Gm : x2Gm, rowStart * this->rowDataNum, (rowEnd - rowStart) * this->rowDataNum);
+            rowStart = rowEnd;
+        }
+    }
+    
+private:
+    // 行长度不一定32B对齐，用DataCopyPad只搬有效的部分
+    // ascend910没有DataCopyPad，最后一块按32B向上取整整块搬运：多写的部分属于下一段，会被后面按顺序搬运的下一段覆盖；
+    // 最后一段多写的部分落在y按32B对齐的尾部，和逐元素路径的写法一致
+    __aicore__ inline void CopyRows(AscendC::GlobalTensor<DTYPE_Y>& srcGm, uint32_t offset, uint32_t dataNum)
+    {
+        for (uint32_t copied = 0; copied < dataNum; copied += this->tileDataNum) {
+            uint32_t copyNum = dataNum - copied < this->tileDataNum ? dataNum - copied : this->tileDataNum;
+            AscendC::LocalTensor<DTYPE_Y> local = queBind.AllocTensor<DTYPE_Y>();
+#if defined(__CCE_AICORE__) && __CCE_AICORE__ == 100
+            constexpr uint32_t blockDataNum = 32 / sizeof(DTYPE_Y);
+            copyNum = (copyNum + blockDataNum - 1) / blockDataNum * blockDataNum;
+            AscendC::DataCopy(local, srcGm[offset + copied], copyNum);
+            queBind.EnQue(local);
+            local = queBind.DeQue<DTYPE_Y>();
+            AscendC::DataCopy(yGm[offset + copied], local, copyNum);
+#else
+            AscendC::DataCopyExtParams copyParams {1, static_cast<uint32_t>(copyNum * sizeof(DTYPE_Y)), 0, 0, 0};
+            AscendC::DataCopyPadExtParams<DTYPE_Y> padParams {false, 0, 0, 0};
+            AscendC::DataCopyPad(local, srcGm[offset + copied], copyParams, padParams);
+            queBind.EnQue(local);
+            local = queBind.DeQue<DTYPE_Y>();
+            AscendC::DataCopyPad(yGm[offset + copied], local, copyParams);
+#endif
+            queBind.FreeTensor(local);
+        }
+    }
+    
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TQueBind<AscendC::QuePosition::VECIN, AscendC::QuePosition::VECOUT, BUFFER_NUM> queBind;
+    
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_Y> x1Gm;
+    AscendC::GlobalTensor<DTYPE_Y> x2Gm;
+    AscendC::GlobalTensor<DTYPE_Y> yGm;
+};
+
+extern "C" __global__ __aicore__ void select_v2(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR bias, GM_ADDR y, GM_ADDR workspace, GM_ADDR tiling) {
     GET_TILING_DATA(tiling_data, tiling);
     AscendC::TPipe pipe;
     
-    if (tiling_data.needBroadcast) {
+    if (tiling_data.tinyTensor) {
+        KernelSelectV2Tiny op;
+        op.Init(condition, x1, x2, y, tiling_data.smallDataNum, &pipe);
+        op.InitEpilogue(bias, tiling_data.epilogueFlags, tiling_data.epilogueScale, tiling_data.epilogueAddScalar);
+        op.Process();
+    } else if (tiling_data.rowCopy) {
+        KernelSelectV2RowCopy op;
+        op.Init(condition, x1, x2, y, tiling_data.tileDataNum, tiling_data.rowNum, tiling_data.rowDataNum, &pipe);
+        op.Process();
+    } else if (tiling_data.tileReuse) {
+        KernelSelectV2TileReuse op;
+        op.Init(condition, x1, x2, y, tiling_data.tileDataNum, 
+                tiling_data.outerNum, tiling_data.innerNum, tiling_data.tileRowNum, tiling_data.tileColNum, 
+                tiling_data.condMode, tiling_data.x1Mode, tiling_data.x2Mode, 
+                &pipe);
+        op.InitEpilogue(bias, tiling_data.epilogueFlags, tiling_data.epilogueScale, tiling_data.epilogueAddScalar);
+        op.Process();
+    } else if (tiling_data.needBroadcast) {
         KernelSelectV2BroadCast op;
         op.Init(condition, x1, x2, y, tiling_data.smallDataNum, tiling_data.finalSmallTileNum, 
                 tiling_data.tileDataNum, tiling_data.smallTailDataNum, 
@@ -600,11 +1168,14 @@ extern "C" __global__ __aicore__ void select_v2(GM_ADDR condition, GM_ADDR x1, G
                 tiling_data.condStrides, tiling_data.x1Strides, tiling_data.x2Strides, tiling_data.yStrides, 
                 tiling_data.condNeedBroadcast, tiling_data.x1NeedBroadcast, tiling_data.x2NeedBroadcast, 
                 &pipe);
+        op.InitEpilogue(bias, tiling_data.epilogueFlags, tiling_data.epilogueScale, tiling_data.epilogueAddScalar,
+                        tiling_data.biasNeedBroadcast, tiling_data.biasStrides);
         op.Process();
     } else {
         KernelSelectV2 op;
         op.Init(condition, x1, x2, y, tiling_data.smallDataNum, tiling_data.finalSmallTileNum, 
                 tiling_data.tileDataNum, tiling_data.smallTailDataNum, &pipe);
+        op.InitEpilogue(bias, tiling_data.epilogueFlags, tiling_data.epilogueScale, tiling_data.epilogueAddScalar);
         op.Process();
     }
-}
\ No newline at end of file
+}
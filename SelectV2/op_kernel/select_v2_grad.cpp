@@ -0,0 +1,822 @@
+#include "kernel_operator.h"
+
+constexpr int32_t BUFFER_NUM = 2;
+constexpr uint32_t COMPARE_ALIGN_NUM = 128; // CompareScalar按256B对齐，half下是128个数
+constexpr uint32_t BLOCK_SIZE = 32;
+constexpr uint32_t FLOAT_BLOCK_NUM = BLOCK_SIZE / sizeof(float); // 一个block里的float个数
+constexpr uint32_t FLOAT_REPEAT_NUM = 64; // 一个repeat最多处理的float个数
+constexpr uint32_t MAX_FOLD_REPEAT = 248; // 一次跨行折叠的行数，不超过255并且按8行对齐，写出的行和保持32B对齐
+
+// 外轴/内轴广播时输入的四种形态，和tiling里的定义一致
+constexpr uint8_t OPERAND_FULL = 0;
+constexpr uint8_t OPERAND_ROW = 1;
+constexpr uint8_t OPERAND_COL = 2;
+constexpr uint8_t OPERAND_SCALAR = 3;
+
+// Duplicate不支持1字节类型，按uint16两个一组填充，count是32的倍数
+template <typename T>
+__aicore__ inline void DuplicateValue(const AscendC::LocalTensor<T>& dstLocal, T value, uint32_t count)
+{
+    if constexpr (sizeof(T) == 1) {
+        uint16_t byte = static_cast<uint8_t>(value);
+        AscendC::Duplicate(dstLocal.template ReinterpretCast<uint16_t>(), static_cast<uint16_t>(byte | (byte << 8)), count / 2);
+    } else {
+        AscendC::Duplicate(dstLocal, value, count);
+    }
+}
+
+// src里rowNum行、每行colNum个float分别求和，结果连续写到dst；src会被改写
+// colNum是8的倍数，rowNum大于1时colNum不超过2040（repeat stride是uint8）
+__aicore__ inline void RowSum(const AscendC::LocalTensor<float>& dstLocal, const AscendC::LocalTensor<float>& srcLocal,
+                              uint32_t rowNum, uint32_t colNum)
+{
+    // 先把每行的后半段加到前半段上，折到不超过64个数，再用WholeReduceSum一个repeat求一行
+    uint8_t repStride = rowNum > 1 ? static_cast<uint8_t>(colNum / FLOAT_BLOCK_NUM) : 0;
+    uint32_t width = colNum;
+    while (width > FLOAT_REPEAT_NUM) {
+        uint32_t foldNum = width / 2 / FLOAT_BLOCK_NUM * FLOAT_BLOCK_NUM;
+        if (rowNum == 1) {
+            AscendC::Add(srcLocal, srcLocal, srcLocal[width - foldNum], foldNum);
+        } else {
+            for (uint32_t rowStart = 0; rowStart < rowNum; rowStart += MAX_FOLD_REPEAT) {
+                uint8_t repeat = static_cast<uint8_t>(rowNum - rowStart < MAX_FOLD_REPEAT ? rowNum - rowStart : MAX_FOLD_REPEAT);
+                uint32_t rowOffset = rowStart * colNum;
+                for (uint32_t col = 0; col < foldNum; col += FLOAT_REPEAT_NUM) {
+                    uint64_t mask = foldNum - col < FLOAT_REPEAT_NUM ? foldNum - col : FLOAT_REPEAT_NUM;
+                    AscendC::Add(srcLocal[rowOffset + col], srcLocal[rowOffset + col], srcLocal[rowOffset + width - foldNum + col],
+                                 mask, repeat, {1, 1, 1, repStride, repStride, repStride});
+                }
+            }
+        }
+        AscendC::PipeBarrier<PIPE_V>();
+        width -= foldNum;
+    }
+    for (uint32_t rowStart = 0; rowStart < rowNum; rowStart += MAX_FOLD_REPEAT) {
+        int32_t repeat = rowNum - rowStart < MAX_FOLD_REPEAT ? rowNum - rowStart : MAX_FOLD_REPEAT;
+        AscendC::WholeReduceSum(dstLocal[rowStart], srcLocal[rowStart * colNum], width, repeat, 1, 1, repStride);
+    }
+    AscendC::PipeBarrier<PIPE_V>();
+}
+
+// src里rowNum行、每行colNum个float按列相加，累加到accLocal上；src会被改写
+__aicore__ inline void ColumnSum(const AscendC::LocalTensor<float>& accLocal, const AscendC::LocalTensor<float>& srcLocal,
+                                 uint32_t rowNum, uint32_t colNum)
+{
+    // 各行在UB里连续，后一半行整块加到前一半上，折log2(rowNum)次只剩一行
+    while (rowNum > 1) {
+        uint32_t foldRowNum = rowNum / 2;
+        AscendC::Add(srcLocal, srcLocal, srcLocal[(rowNum - foldRowNum) * colNum], foldRowNum * colNum);
+        AscendC::PipeBarrier<PIPE_V>();
+        rowNum -= foldRowNum;
+    }
+    AscendC::Add(accLocal, accLocal, srcLocal, colNum);
+}
+
+// 选出的梯度转成float再规约，half时先选到tmpBuf里
+template <typename T>
+__aicore__ inline void SelectToFloat(const AscendC::LocalTensor<float>& dstLocal, const AscendC::LocalTensor<uint8_t>& selMask,
+                                     const AscendC::LocalTensor<T>& src0Local, const AscendC::LocalTensor<T>& src1Local,
+                                     AscendC::TBuf<AscendC::TPosition::VECCALC>& tmpBuf, uint32_t count)
+{
+    if constexpr (std::is_same_v<T, float>) {
+        AscendC::Select(dstLocal, selMask, src0Local, src1Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+    } else {
+        AscendC::LocalTensor<T> selLocal = tmpBuf.Get<T>();
+        AscendC::Select(selLocal, selMask, src0Local, src1Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, count);
+        AscendC::Cast(dstLocal, selLocal, AscendC::RoundMode::CAST_NONE, count);
+    }
+}
+
+class KernelSelectV2Grad {
+private:
+    uint32_t tileDataNum; // 除了最后一次，tile里的数据数量
+    uint32_t dataNum; // 这个核要计算的数据数量
+    uint32_t tileNum; // 这个核要计算的tile数量
+    uint32_t tailDataNum; // 这个核最后一次计算的数据数量
+    uint32_t processDataNum; // 这次要处理的数据数量
+    uint32_t validDataNum; // 这次要处理的数据里真正有效的数量，去掉了32对齐补出来的部分
+    uint32_t compareDataNum; // processDataNum按CompareScalar对齐后的数量
+    uint32_t totalDataNum; // dy真实的元素个数
+private:
+    uint16_t* yShape;
+    uint8_t yDimNum;
+
+    uint8_t condNeedBroadcast;
+    uint8_t x1NeedReduce;
+    uint8_t x2NeedReduce;
+    uint32_t dx1DataNum;
+    uint32_t dx2DataNum;
+    uint8_t accInWorkspace; // 累加区放不进UB时在workspace里累加
+
+    uint32_t* condStrides;
+    uint32_t* x1Strides;
+    uint32_t* x2Strides;
+    uint32_t* yStrides;
+
+public:
+    __aicore__ inline KernelSelectV2Grad() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR dy, GM_ADDR dx1, GM_ADDR dx2,
+                                uint32_t smallDataNum, uint32_t finalSmallTileNum,
+                                uint32_t tileDataNum, uint32_t smallTailDataNum, uint32_t totalDataNum,
+                                uint16_t* yShape, uint8_t yDimNum,
+                                uint32_t* condStrides, uint32_t* x1Strides, uint32_t* x2Strides, uint32_t* yStrides,
+                                uint8_t condNeedBroadcast, uint8_t x1NeedReduce, uint8_t x2NeedReduce,
+                                uint32_t dx1DataNum, uint32_t dx2DataNum,
+                                GM_ADDR workspace, uint8_t accInWorkspace,
+                                AscendC::TPipe* pipeIn)
+    {
+        uint32_t blockNum = AscendC::GetBlockNum();
+        ASSERT(blockNum != 0 && "GetBlockNum() is 0");
+
+        this->tileDataNum = tileDataNum;
+
+        this->dataNum = smallDataNum;
+        this->tileNum = finalSmallTileNum;
+        this->tailDataNum = smallTailDataNum;
+        this->totalDataNum = totalDataNum;
+
+        // 广播相关参数
+        this->yShape = yShape;
+        this->yDimNum = yDimNum;
+
+        this->condStrides = condStrides;
+        this->x1Strides = x1Strides;
+        this->x2Strides = x2Strides;
+        this->yStrides = yStrides;
+
+        this->condNeedBroadcast = condNeedBroadcast;
+        this->x1NeedReduce = x1NeedReduce;
+        this->x2NeedReduce = x2NeedReduce;
+        this->dx1DataNum = dx1DataNum;
+        this->dx2DataNum = dx2DataNum;
+        this->accInWorkspace = accInWorkspace;
+
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition, this->dataNum);
+        dyGm.SetGlobalBuffer((__gm__ DTYPE_DY *)dy, this->dataNum);
+        dx1Gm.SetGlobalBuffer((__gm__ DTYPE_DX1 *)dx1, this->x1NeedReduce ? this->dx1DataNum : this->dataNum);
+        dx2Gm.SetGlobalBuffer((__gm__ DTYPE_DX2 *)dx2, this->x2NeedReduce ? this->dx2DataNum : this->dataNum);
+        if (this->accInWorkspace) {
+            uint32_t acc1DataNum = this->x1NeedReduce ? (this->dx1DataNum + FLOAT_BLOCK_NUM - 1) / FLOAT_BLOCK_NUM * FLOAT_BLOCK_NUM : 0;
+            acc1Gm.SetGlobalBuffer((__gm__ float *)workspace, acc1DataNum);
+            acc2Gm.SetGlobalBuffer((__gm__ float *)workspace + acc1DataNum, this->x2NeedReduce ? this->dx2DataNum : 0);
+        }
+
+        pipe = pipeIn;
+        pipe->InitBuffer(inQueueCondition, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_CONDITION));
+        pipe->InitBuffer(inQueueDy, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DY));
+        pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
+        pipe->InitBuffer(zeroBuf, this->tileDataNum * sizeof(DTYPE_DY));
+
+        // 不需要规约的dx按tile写回；需要规约的dx用float累加，全部算完再写回
+        // 累加区一般常驻UB；放不进UB时在workspace里累加，只用标量读写，不需要和搬运指令同步
+        if (this->x1NeedReduce || this->x2NeedReduce) {
+            pipe->InitBuffer(selBuf, this->tileDataNum * sizeof(DTYPE_DY));
+        }
+        if (!this->x1NeedReduce) {
+            pipe->InitBuffer(outQueueDx1, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DX1));
+        } else if (!this->accInWorkspace) {
+            pipe->InitBuffer(acc1, (this->dx1DataNum * sizeof(float) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE);
+        }
+        if (!this->x2NeedReduce) {
+            pipe->InitBuffer(outQueueDx2, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DX2));
+        } else if (!this->accInWorkspace) {
+            pipe->InitBuffer(acc2, (this->dx2DataNum * sizeof(float) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE);
+        }
+        if constexpr (std::is_same_v<DTYPE_DY, half>) {
+            // 只按需要规约的dx算，不需要规约的dx元素个数是整个dy，和tiling的预算一致
+            uint32_t castDataNum = this->x1NeedReduce ? this->dx1DataNum : 0;
+            if (this->x2NeedReduce && this->dx2DataNum > castDataNum) {
+                castDataNum = this->dx2DataNum;
+            }
+            if ((this->x1NeedReduce || this->x2NeedReduce) && !this->accInWorkspace) {
+                pipe->InitBuffer(castBuf, (castDataNum * sizeof(half) + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE);
+            }
+        }
+
+        AscendC::Duplicate(zeroBuf.Get<DTYPE_DY>(), (DTYPE_DY)0, this->tileDataNum);
+        if (this->x1NeedReduce) {
+            ClearAcc(acc1, acc1Gm, this->dx1DataNum);
+        }
+        if (this->x2NeedReduce) {
+            ClearAcc(acc2, acc2Gm, this->dx2DataNum);
+        }
+    }
+
+    __aicore__ inline void Process()
+    {
+        int32_t loopCount = this->tileNum;
+        for (int32_t i = 0; i < loopCount; i++) {
+            this->processDataNum = (i == loopCount - 1) ? this->tailDataNum : this->tileDataNum;
+            this->compareDataNum = (this->processDataNum + COMPARE_ALIGN_NUM - 1) / COMPARE_ALIGN_NUM * COMPARE_ALIGN_NUM;
+            uint32_t remainDataNum = this->totalDataNum - i * this->tileDataNum;
+            this->validDataNum = remainDataNum < this->processDataNum ? remainDataNum : this->processDataNum;
+            CopyIn(i);
+            Compute(i);
+            CopyOut(i);
+        }
+
+        if (this->x1NeedReduce || this->x2NeedReduce) {
+            AscendC::PipeBarrier<PIPE_ALL>();
+        }
+        if (this->x1NeedReduce) {
+            CopyOutReduced(acc1, acc1Gm, dx1Gm, this->dx1DataNum);
+        }
+        if (this->x2NeedReduce) {
+            CopyOutReduced(acc2, acc2Gm, dx2Gm, this->dx2DataNum);
+        }
+    }
+
+private:
+    __aicore__ inline void ClearAcc(AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf, AscendC::GlobalTensor<float>& accGm,
+                                    uint32_t dxDataNum)
+    {
+        if (this->accInWorkspace) {
+            for (uint32_t i = 0; i < dxDataNum; i++) {
+                accGm.SetValue(i, 0.0f);
+            }
+        } else {
+            AscendC::Duplicate(accBuf.Get<float>(), (float)0, dxDataNum);
+        }
+    }
+
+    // y中下标为n的元素在某个输入里的偏移，同时记下每一维的进度，供NextOffset逐个递推
+    __aicore__ inline uint32_t InitOffset(uint32_t n, uint32_t* strides, uint32_t* r, uint32_t* indices)
+    {
+        uint32_t offset = 0;
+        for (uint8_t i = 0; i < this->yDimNum; i++) {
+            if (strides[i] == 0) {
+                continue;
+            }
+            r[i] = n % yStrides[i];
+            indices[i] = n / yStrides[i] % yShape[i];
+            offset += indices[i] * strides[i];
+        }
+        return offset;
+    }
+
+    __aicore__ inline uint32_t NextOffset(uint32_t offset, uint32_t* strides, uint32_t* r, uint32_t* indices)
+    {
+        for (uint8_t dim = 0; dim < this->yDimNum; dim++) {
+            const uint32_t& stride = strides[dim];
+            if (stride == 0) {
+                continue;
+            }
+            uint32_t &rdim = r[dim];
+            if (rdim + 1 == yStrides[dim]) {
+                rdim = 0;
+                uint32_t &indice = indices[dim];
+                if (indice + 1 == yShape[dim]) {
+                    offset -= indice * stride;
+                    indice = 0;
+                } else {
+                    offset += stride;
+                    indice += 1;
+                }
+            } else {
+                ++rdim;
+            }
+        }
+        return offset;
+    }
+
+    __aicore__ inline void CopyIn(int32_t progress)
+    {
+        AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = inQueueCondition.AllocTensor<DTYPE_CONDITION>();
+        AscendC::LocalTensor<DTYPE_DY> dyLocal = inQueueDy.AllocTensor<DTYPE_DY>();
+
+        if (this->condNeedBroadcast) {
+            uint32_t r[8] {};
+            uint32_t indices[8] {};
+            uint32_t currentOffset = InitOffset(progress * this->tileDataNum, condStrides, r, indices);
+            conditionLocal.SetValue(0, conditionGm.GetValue(currentOffset));
+            for (int i = 1; i < this->processDataNum; i++) {
+                currentOffset = NextOffset(currentOffset, condStrides, r, indices);
+                conditionLocal.SetValue(i, conditionGm.GetValue(currentOffset));
+            }
+        } else {
+            AscendC::DataCopy(conditionLocal, conditionGm[progress * this->tileDataNum], this->processDataNum);
+        }
+        AscendC::DataCopy(dyLocal, dyGm[progress * this->tileDataNum], this->processDataNum);
+
+        inQueueCondition.EnQue(conditionLocal);
+        inQueueDy.EnQue(dyLocal);
+    }
+
+    __aicore__ inline void Compute(int32_t progress)
+    {
+        AscendC::LocalTensor<DTYPE_DY> dyLocal = inQueueDy.DeQue<DTYPE_DY>();
+        AscendC::LocalTensor<int8_t> _conditionLocal = inQueueCondition.DeQue<int8_t>();
+
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
+        AscendC::LocalTensor<DTYPE_DY> zeroLocal = zeroBuf.Get<DTYPE_DY>();
+
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->compareDataNum);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->compareDataNum);
+
+        // dx1 = where(cond, dy, 0)，dx2 = where(cond, 0, dy)，共用同一个selMask
+        if (this->x1NeedReduce) {
+            AscendC::LocalTensor<DTYPE_DY> selLocal = selBuf.Get<DTYPE_DY>();
+            AscendC::Select(selLocal, selMask, dyLocal, zeroLocal, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
+            Accumulate(acc1, acc1Gm, selLocal, x1Strides, progress);
+        } else {
+            AscendC::LocalTensor<DTYPE_DX1> dx1Local = outQueueDx1.AllocTensor<DTYPE_DX1>();
+            AscendC::Select(dx1Local, selMask, dyLocal, zeroLocal, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
+            outQueueDx1.EnQue<DTYPE_DX1>(dx1Local);
+        }
+        if (this->x2NeedReduce) {
+            AscendC::LocalTensor<DTYPE_DY> selLocal = selBuf.Get<DTYPE_DY>();
+            AscendC::Select(selLocal, selMask, zeroLocal, dyLocal, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
+            Accumulate(acc2, acc2Gm, selLocal, x2Strides, progress);
+        } else {
+            AscendC::LocalTensor<DTYPE_DX2> dx2Local = outQueueDx2.AllocTensor<DTYPE_DX2>();
+            AscendC::Select(dx2Local, selMask, zeroLocal, dyLocal, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
+            outQueueDx2.EnQue<DTYPE_DX2>(dx2Local);
+        }
+
+        inQueueCondition.FreeTensor(_conditionLocal);
+        inQueueDy.FreeTensor(dyLocal);
+    }
+
+    // 把这个tile选出来的梯度按广播关系加到累加区里，只累加真实有效的元素
+    // 只有任意stride的广播才走这里，外轴/内轴广播由KernelSelectV2GradTileReduce用向量指令规约
+    __aicore__ inline void Accumulate(AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf, AscendC::GlobalTensor<float>& accGm,
+                                      AscendC::LocalTensor<DTYPE_DY>& selLocal, uint32_t* strides, int32_t progress)
+    {
+        event_t eventIdVToS = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_S));
+        AscendC::SetFlag<AscendC::HardEvent::V_S>(eventIdVToS);
+        AscendC::WaitFlag<AscendC::HardEvent::V_S>(eventIdVToS);
+
+        uint32_t r[8] {};
+        uint32_t indices[8] {};
+        uint32_t currentOffset = InitOffset(progress * this->tileDataNum, strides, r, indices);
+        for (uint32_t i = 0; i < this->validDataNum; i++) {
+            if (i > 0) {
+                currentOffset = NextOffset(currentOffset, strides, r, indices);
+            }
+            float grad = static_cast<float>(selLocal.GetValue(i));
+            if (this->accInWorkspace) {
+                accGm.SetValue(currentOffset, accGm.GetValue(currentOffset) + grad);
+            } else {
+                AscendC::LocalTensor<float> accLocal = accBuf.Get<float>();
+                accLocal.SetValue(currentOffset, accLocal.GetValue(currentOffset) + grad);
+            }
+        }
+
+        event_t eventIdSToV = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::S_V));
+        AscendC::SetFlag<AscendC::HardEvent::S_V>(eventIdSToV);
+        AscendC::WaitFlag<AscendC::HardEvent::S_V>(eventIdSToV);
+    }
+
+    __aicore__ inline void CopyOut(int32_t progress)
+    {
+        if (!this->x1NeedReduce) {
+            AscendC::LocalTensor<DTYPE_DX1> dx1Local = outQueueDx1.DeQue<DTYPE_DX1>();
+            AscendC::DataCopy(dx1Gm[progress * this->tileDataNum], dx1Local, this->processDataNum);
+            outQueueDx1.FreeTensor(dx1Local);
+        }
+        if (!this->x2NeedReduce) {
+            AscendC::LocalTensor<DTYPE_DX2> dx2Local = outQueueDx2.DeQue<DTYPE_DX2>();
+            AscendC::DataCopy(dx2Gm[progress * this->tileDataNum], dx2Local, this->processDataNum);
+            outQueueDx2.FreeTensor(dx2Local);
+        }
+    }
+
+    template<typename T>
+    __aicore__ inline void CopyOutReduced(AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf, AscendC::GlobalTensor<float>& accGm,
+                                          AscendC::GlobalTensor<T>& dxGm, uint32_t dxDataNum)
+    {
+        if (this->accInWorkspace) {
+            CopyOutReducedFromWorkspace(accGm, dxGm, dxDataNum);
+            return;
+        }
+        AscendC::LocalTensor<float> accLocal = accBuf.Get<float>();
+        AscendC::DataCopyExtParams copyParams {1, static_cast<uint32_t>(dxDataNum * sizeof(T)), 0, 0, 0};
+        if constexpr (std::is_same_v<T, half>) {
+            AscendC::LocalTensor<half> castLocal = castBuf.Get<half>();
+            AscendC::Cast(castLocal, accLocal, AscendC::RoundMode::CAST_NONE, dxDataNum);
+            event_t eventIdVToMte3 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_MTE3));
+            AscendC::SetFlag<AscendC::HardEvent::V_MTE3>(eventIdVToMte3);
+            AscendC::WaitFlag<AscendC::HardEvent::V_MTE3>(eventIdVToMte3);
+            AscendC::DataCopyPad(dxGm, castLocal, copyParams);
+        } else {
+            AscendC::DataCopyPad(dxGm, accLocal, copyParams);
+        }
+        AscendC::PipeBarrier<PIPE_ALL>();
+    }
+
+    // workspace里的累加结果按tile用标量读出、转成输出类型放进selBuf，再整块写回
+    template<typename T>
+    __aicore__ inline void CopyOutReducedFromWorkspace(AscendC::GlobalTensor<float>& accGm, AscendC::GlobalTensor<T>& dxGm,
+                                                       uint32_t dxDataNum)
+    {
+        AscendC::LocalTensor<T> dxLocal = selBuf.Get<T>();
+        for (uint32_t start = 0; start < dxDataNum; start += this->tileDataNum) {
+            uint32_t copyNum = dxDataNum - start < this->tileDataNum ? dxDataNum - start : this->tileDataNum;
+            for (uint32_t i = 0; i < copyNum; i++) {
+                dxLocal.SetValue(i, static_cast<T>(accGm.GetValue(start + i)));
+            }
+            event_t eventIdSToMte3 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::S_MTE3));
+            AscendC::SetFlag<AscendC::HardEvent::S_MTE3>(eventIdSToMte3);
+            AscendC::WaitFlag<AscendC::HardEvent::S_MTE3>(eventIdSToMte3);
+            AscendC::DataCopyExtParams copyParams {1, static_cast<uint32_t>(copyNum * sizeof(T)), 0, 0, 0};
+            AscendC::DataCopyPad(dxGm[start], dxLocal, copyParams);
+            event_t eventIdMte3ToS = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::MTE3_S));
+            AscendC::SetFlag<AscendC::HardEvent::MTE3_S>(eventIdMte3ToS);
+            AscendC::WaitFlag<AscendC::HardEvent::MTE3_S>(eventIdMte3ToS);
+        }
+    }
+
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueDy;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueDx1;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueDx2;
+
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> zeroBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> selBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> acc1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> acc2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> castBuf;
+
+    AscendC::GlobalTensor<DTYPE_DY> dyGm;
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_DX1> dx1Gm;
+    AscendC::GlobalTensor<DTYPE_DX2> dx2Gm;
+    AscendC::GlobalTensor<float> acc1Gm;
+    AscendC::GlobalTensor<float> acc2Gm;
+};
+
+// 外轴/内轴广播的反向：dy按[outerNum, innerNum]分块，cond按形态整块搬运或常驻UB，dx1/dx2按形态用向量指令规约
+// ROW：同一列块内各行按列相加；COL：每行求和；SCALAR：整个tile求和
+class KernelSelectV2GradTileReduce {
+private:
+    uint32_t tileDataNum; // tile里最多的数据数量
+    uint32_t processDataNum; // 这次要处理的数据数量
+    uint32_t compareDataNum; // processDataNum按CompareScalar对齐后的数量
+private:
+    uint32_t outerNum; // dy的外轴长度（行数）
+    uint32_t innerNum; // dy的内轴长度（列数）
+    uint32_t tileRowNum; // 一个tile里的行数
+    uint32_t tileColNum; // 一个tile里的列数
+    uint32_t rowNum; // 这次要处理的行数
+    uint32_t colNum; // 这次要处理的列数
+    uint32_t colChunkNum; // 一行被切成几段
+    uint32_t partialRowNum; // workspace里每段部分和的长度，outerNum按32B对齐
+
+    uint8_t condMode;
+    uint8_t x1Mode;
+    uint8_t x2Mode;
+
+public:
+    __aicore__ inline KernelSelectV2GradTileReduce() {}
+    __aicore__ inline void Init(GM_ADDR condition, GM_ADDR dy, GM_ADDR dx1, GM_ADDR dx2, GM_ADDR workspace,
+                                uint32_t tileDataNum, uint32_t outerNum, uint32_t innerNum, uint32_t tileRowNum, uint32_t tileColNum,
+                                uint8_t condMode, uint8_t x1Mode, uint8_t x2Mode,
+                                AscendC::TPipe* pipeIn)
+    {
+        uint32_t blockNum = AscendC::GetBlockNum();
+        ASSERT(blockNum != 0 && "GetBlockNum() is 0");
+
+        this->tileDataNum = tileDataNum;
+        this->outerNum = outerNum;
+        this->innerNum = innerNum;
+        this->tileRowNum = tileRowNum;
+        this->tileColNum = tileColNum;
+        this->condMode = condMode;
+        this->x1Mode = x1Mode;
+        this->x2Mode = x2Mode;
+        this->colChunkNum = (this->innerNum + this->tileColNum - 1) / this->tileColNum;
+        this->partialRowNum = (this->outerNum + FLOAT_BLOCK_NUM - 1) / FLOAT_BLOCK_NUM * FLOAT_BLOCK_NUM;
+
+        conditionGm.SetGlobalBuffer((__gm__ DTYPE_CONDITION *)condition, OperandDataNum(this->condMode));
+        dyGm.SetGlobalBuffer((__gm__ DTYPE_DY *)dy, this->outerNum * this->innerNum);
+        dx1Gm.SetGlobalBuffer((__gm__ DTYPE_DX1 *)dx1, OperandDataNum(this->x1Mode));
+        dx2Gm.SetGlobalBuffer((__gm__ DTYPE_DX2 *)dx2, OperandDataNum(this->x2Mode));
+        // 一行被切成多段时，按列求和的每段部分和按[colChunkNum, partialRowNum]放在workspace里
+        uint32_t partialDataNum = this->colChunkNum > 1 ? this->colChunkNum * this->partialRowNum : 0;
+        uint32_t partial1DataNum = this->x1Mode == OPERAND_COL ? partialDataNum : 0;
+        partial1Gm.SetGlobalBuffer((__gm__ float *)workspace, partial1DataNum);
+        partial2Gm.SetGlobalBuffer((__gm__ float *)workspace + partial1DataNum, this->x2Mode == OPERAND_COL ? partialDataNum : 0);
+
+        pipe = pipeIn;
+        if (this->condMode == OPERAND_FULL) {
+            pipe->InitBuffer(inQueueCondition, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_CONDITION));
+        } else {
+            pipe->InitBuffer(condBuf, this->tileDataNum * sizeof(DTYPE_CONDITION));
+        }
+        pipe->InitBuffer(inQueueDy, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DY));
+        // FULL的dx按tile写回，其余的dx用同一个队列写回规约结果
+        pipe->InitBuffer(outQueueDx1, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DX1));
+        pipe->InitBuffer(outQueueDx2, BUFFER_NUM, this->tileDataNum * sizeof(DTYPE_DX2));
+        pipe->InitBuffer(tmp1, this->tileDataNum * sizeof(half));
+        pipe->InitBuffer(tmp2, this->tileDataNum * sizeof(uint8_t));
+        pipe->InitBuffer(zeroBuf, this->tileDataNum * sizeof(DTYPE_DY));
+
+        if (this->x1Mode != OPERAND_FULL || this->x2Mode != OPERAND_FULL) {
+            pipe->InitBuffer(selFloatBuf, this->tileDataNum * sizeof(float));
+            if constexpr (!std::is_same_v<DTYPE_DY, float>) {
+                pipe->InitBuffer(selBuf, this->tileDataNum * sizeof(DTYPE_DY));
+            }
+        }
+        InitAcc(acc1, this->x1Mode);
+        InitAcc(acc2, this->x2Mode);
+        if (this->x1Mode == OPERAND_COL || this->x1Mode == OPERAND_SCALAR ||
+            this->x2Mode == OPERAND_COL || this->x2Mode == OPERAND_SCALAR) {
+            uint32_t rowSumNum = (this->tileRowNum + FLOAT_BLOCK_NUM - 1) / FLOAT_BLOCK_NUM * FLOAT_BLOCK_NUM;
+            pipe->InitBuffer(rowSumBuf, rowSumNum * sizeof(float));
+        }
+
+        AscendC::Duplicate(zeroBuf.Get<DTYPE_DY>(), (DTYPE_DY)0, this->tileDataNum);
+        if (this->condMode == OPERAND_SCALAR) {
+            DuplicateValue(condBuf.Get<DTYPE_CONDITION>(), conditionGm.GetValue(0), this->tileDataNum);
+        }
+    }
+
+    __aicore__ inline void Process()
+    {
+        // 外层按列块、内层按行块，和前向一致；ROW类的cond和累加区在一个列块内一直复用
+        uint32_t chunkIndex = 0;
+        for (uint32_t colStart = 0; colStart < this->innerNum; colStart += this->tileColNum, chunkIndex++) {
+            this->colNum = this->innerNum - colStart < this->tileColNum ? this->innerNum - colStart : this->tileColNum;
+            LoadRowCondition(colStart);
+            ClearRowAcc(acc1, this->x1Mode);
+            ClearRowAcc(acc2, this->x2Mode);
+            for (uint32_t rowStart = 0; rowStart < this->outerNum; rowStart += this->tileRowNum) {
+                this->rowNum = this->outerNum - rowStart < this->tileRowNum ? this->outerNum - rowStart : this->tileRowNum;
+                this->processDataNum = this->rowNum * this->colNum;
+                this->compareDataNum = (this->processDataNum + COMPARE_ALIGN_NUM - 1) / COMPARE_ALIGN_NUM * COMPARE_ALIGN_NUM;
+                uint32_t offset = rowStart * this->innerNum + colStart;
+                CopyIn(offset, rowStart);
+                Compute(rowStart, chunkIndex);
+                CopyOut(offset);
+            }
+            if (this->x1Mode == OPERAND_ROW) {
+                CopyOutFloat(outQueueDx1, dx1Gm, colStart, acc1.Get<float>(), this->colNum);
+            }
+            if (this->x2Mode == OPERAND_ROW) {
+                CopyOutFloat(outQueueDx2, dx2Gm, colStart, acc2.Get<float>(), this->colNum);
+            }
+        }
+
+        if (this->x1Mode == OPERAND_SCALAR) {
+            CopyOutFloat(outQueueDx1, dx1Gm, 0, acc1.Get<float>(), 1);
+        }
+        if (this->x2Mode == OPERAND_SCALAR) {
+            CopyOutFloat(outQueueDx2, dx2Gm, 0, acc2.Get<float>(), 1);
+        }
+        if (this->colChunkNum > 1 && this->x1Mode == OPERAND_COL) {
+            ReducePartials(outQueueDx1, dx1Gm, partial1Gm);
+        }
+        if (this->colChunkNum > 1 && this->x2Mode == OPERAND_COL) {
+            ReducePartials(outQueueDx2, dx2Gm, partial2Gm);
+        }
+    }
+
+private:
+    __aicore__ inline uint32_t OperandDataNum(uint8_t mode)
+    {
+        if (mode == OPERAND_ROW) {
+            return this->innerNum;
+        } else if (mode == OPERAND_COL) {
+            return this->outerNum;
+        } else if (mode == OPERAND_SCALAR) {
+            return 1;
+        }
+        return this->outerNum * this->innerNum;
+    }
+
+    // ROW的累加区是一个列块长，SCALAR只要一个block
+    __aicore__ inline void InitAcc(AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf, uint8_t mode)
+    {
+        if (mode == OPERAND_ROW) {
+            pipe->InitBuffer(accBuf, this->tileColNum * sizeof(float));
+        } else if (mode == OPERAND_SCALAR) {
+            pipe->InitBuffer(accBuf, BLOCK_SIZE);
+            AscendC::Duplicate(accBuf.Get<float>(), (float)0, FLOAT_BLOCK_NUM);
+        }
+    }
+
+    __aicore__ inline void ClearRowAcc(AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf, uint8_t mode)
+    {
+        if (mode == OPERAND_ROW) {
+            AscendC::Duplicate(accBuf.Get<float>(), (float)0, this->colNum);
+        }
+    }
+
+    // cond是ROW时每个列块开始搬一行，再按倍增复制到tileRowNum行
+    __aicore__ inline void LoadRowCondition(uint32_t colStart)
+    {
+        if (this->condMode != OPERAND_ROW) {
+            return;
+        }
+        // 常驻区会被覆盖，先等上一个列块的计算全部完成
+        AscendC::PipeBarrier<PIPE_ALL>();
+        AscendC::LocalTensor<DTYPE_CONDITION> condLocal = condBuf.Get<DTYPE_CONDITION>();
+        AscendC::DataCopy(condLocal, conditionGm[colStart], this->colNum);
+        AscendC::PipeBarrier<PIPE_ALL>();
+        uint32_t filledNum = this->colNum;
+        uint32_t totalNum = this->tileRowNum * this->colNum;
+        while (filledNum < totalNum) {
+            uint32_t copyNum = totalNum - filledNum < filledNum ? totalNum - filledNum : filledNum;
+            AscendC::DataCopy(condLocal[filledNum], condLocal, copyNum);
+            AscendC::PipeBarrier<PIPE_ALL>();
+            filledNum += copyNum;
+        }
+    }
+
+    __aicore__ inline void CopyIn(uint32_t offset, uint32_t rowStart)
+    {
+        if (this->condMode == OPERAND_FULL) {
+            AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = inQueueCondition.AllocTensor<DTYPE_CONDITION>();
+            AscendC::DataCopy(conditionLocal, conditionGm[offset], this->processDataNum);
+            inQueueCondition.EnQue(conditionLocal);
+        } else if (this->condMode == OPERAND_COL) {
+            // 每行一个值，按行填满
+            AscendC::LocalTensor<DTYPE_CONDITION> conditionLocal = condBuf.Get<DTYPE_CONDITION>();
+            for (uint32_t i = 0; i < this->rowNum; i++) {
+                DuplicateValue(conditionLocal[i * this->colNum], conditionGm.GetValue(rowStart + i), this->colNum);
+            }
+        }
+        AscendC::LocalTensor<DTYPE_DY> dyLocal = inQueueDy.AllocTensor<DTYPE_DY>();
+        AscendC::DataCopy(dyLocal, dyGm[offset], this->processDataNum);
+        inQueueDy.EnQue(dyLocal);
+    }
+
+    __aicore__ inline void Compute(uint32_t rowStart, uint32_t chunkIndex)
+    {
+        AscendC::LocalTensor<DTYPE_DY> dyLocal = inQueueDy.DeQue<DTYPE_DY>();
+        AscendC::LocalTensor<int8_t> _conditionLocal;
+        if (this->condMode == OPERAND_FULL) {
+            _conditionLocal = inQueueCondition.DeQue<int8_t>();
+        } else {
+            _conditionLocal = condBuf.Get<int8_t>();
+        }
+
+        AscendC::LocalTensor<half> conditionLocal = tmp1.Get<half>();
+        AscendC::LocalTensor<uint8_t> selMask = tmp2.Get<uint8_t>();
+        AscendC::LocalTensor<DTYPE_DY> zeroLocal = zeroBuf.Get<DTYPE_DY>();
+
+        AscendC::Cast(conditionLocal, _conditionLocal, AscendC::RoundMode::CAST_NONE, this->compareDataNum);
+        AscendC::CompareScalar(selMask, conditionLocal, (half)0, AscendC::CMPMODE::GT, this->compareDataNum);
+
+        // dx1 = where(cond, dy, 0)，dx2 = where(cond, 0, dy)，共用同一个selMask
+        SelectGrad(outQueueDx1, acc1, dx1Gm, partial1Gm, this->x1Mode, selMask, dyLocal, zeroLocal, rowStart, chunkIndex);
+        SelectGrad(outQueueDx2, acc2, dx2Gm, partial2Gm, this->x2Mode, selMask, zeroLocal, dyLocal, rowStart, chunkIndex);
+
+        if (this->condMode == OPERAND_FULL) {
+            inQueueCondition.FreeTensor(_conditionLocal);
+        }
+        inQueueDy.FreeTensor(dyLocal);
+    }
+
+    template <typename T>
+    __aicore__ inline void SelectGrad(AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM>& que,
+                                      AscendC::TBuf<AscendC::TPosition::VECCALC>& accBuf,
+                                      AscendC::GlobalTensor<T>& dxGm, AscendC::GlobalTensor<float>& partialGm, uint8_t mode,
+                                      const AscendC::LocalTensor<uint8_t>& selMask, const AscendC::LocalTensor<DTYPE_DY>& src0Local,
+                                      const AscendC::LocalTensor<DTYPE_DY>& src1Local, uint32_t rowStart, uint32_t chunkIndex)
+    {
+        if (mode == OPERAND_FULL) {
+            AscendC::LocalTensor<T> dxLocal = que.AllocTensor<T>();
+            AscendC::Select(dxLocal, selMask, src0Local, src1Local, AscendC::SELMODE::VSEL_TENSOR_TENSOR_MODE, this->processDataNum);
+            que.EnQue<T>(dxLocal);
+            return;
+        }
+
+        AscendC::LocalTensor<float> selLocal = selFloatBuf.Get<float>();
+        SelectToFloat(selLocal, selMask, src0Local, src1Local, selBuf, this->processDataNum);
+        if (mode == OPERAND_ROW) {
+            ColumnSum(accBuf.Get<float>(), selLocal, this->rowNum, this->colNum);
+        } else if (mode == OPERAND_SCALAR) {
+            AscendC::LocalTensor<float> accLocal = accBuf.Get<float>();
+            AscendC::LocalTensor<float> rowSumLocal = rowSumBuf.Get<float>();
+            RowSum(rowSumLocal, selLocal, 1, this->processDataNum);
+            AscendC::Add(accLocal, accLocal, rowSumLocal, 1);
+        } else {
+            AscendC::LocalTensor<float> rowSumLocal = rowSumBuf.Get<float>();
+            RowSum(rowSumLocal, selLocal, this->rowNum, this->colNum);
+            if (this->colChunkNum > 1) {
+                // 一行被切成多段时一个tile只有一行，先把这一段的部分和写到workspace
+                CopyOutFloat(que, partialGm, chunkIndex * this->partialRowNum + rowStart, rowSumLocal, 1);
+            } else {
+                CopyOutFloat(que, dxGm, rowStart, rowSumLocal, this->rowNum);
+            }
+        }
+    }
+
+    __aicore__ inline void CopyOut(uint32_t offset)
+    {
+        if (this->x1Mode == OPERAND_FULL) {
+            AscendC::LocalTensor<DTYPE_DX1> dx1Local = outQueueDx1.DeQue<DTYPE_DX1>();
+            AscendC::DataCopy(dx1Gm[offset], dx1Local, this->processDataNum);
+            outQueueDx1.FreeTensor(dx1Local);
+        }
+        if (this->x2Mode == OPERAND_FULL) {
+            AscendC::LocalTensor<DTYPE_DX2> dx2Local = outQueueDx2.DeQue<DTYPE_DX2>();
+            AscendC::DataCopy(dx2Gm[offset], dx2Local, this->processDataNum);
+            outQueueDx2.FreeTensor(dx2Local);
+        }
+    }
+
+    // float的规约结果转成输出类型写回，长度不一定32B对齐
+    template <typename T>
+    __aicore__ inline void CopyOutFloat(AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM>& que, AscendC::GlobalTensor<T>& dstGm,
+                                        uint32_t offset, const AscendC::LocalTensor<float>& srcLocal, uint32_t dataNum)
+    {
+        AscendC::LocalTensor<T> dstLocal = que.AllocTensor<T>();
+        if constexpr (std::is_same_v<T, float>) {
+            AscendC::Adds(dstLocal, srcLocal, (float)0, dataNum);
+        } else {
+            AscendC::Cast(dstLocal, srcLocal, AscendC::RoundMode::CAST_NONE, dataNum);
+        }
+        que.EnQue<T>(dstLocal);
+        dstLocal = que.DeQue<T>();
+        AscendC::DataCopyExtParams copyParams {1, static_cast<uint32_t>(dataNum * sizeof(T)), 0, 0, 0};
+        AscendC::DataCopyPad(dstGm[offset], dstLocal, copyParams);
+        que.FreeTensor(dstLocal);
+    }
+
+    // 按行块把workspace里各段的部分和加起来，selFloatBuf前一半做累加、后一半放搬进来的部分和
+    template <typename T>
+    __aicore__ inline void ReducePartials(AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM>& que, AscendC::GlobalTensor<T>& dxGm,
+                                          AscendC::GlobalTensor<float>& partialGm)
+    {
+        // 部分和都写完才能读
+        AscendC::PipeBarrier<PIPE_ALL>();
+        uint32_t blockRowNum = this->tileDataNum / 2;
+        AscendC::LocalTensor<float> accLocal = selFloatBuf.Get<float>();
+        AscendC::LocalTensor<float> partialLocal = accLocal[blockRowNum];
+        for (uint32_t rowStart = 0; rowStart < this->outerNum; rowStart += blockRowNum) {
+            uint32_t rowNum = this->outerNum - rowStart < blockRowNum ? this->outerNum - rowStart : blockRowNum;
+            uint32_t alignRowNum = (rowNum + FLOAT_BLOCK_NUM - 1) / FLOAT_BLOCK_NUM * FLOAT_BLOCK_NUM;
+            AscendC::Duplicate(accLocal, (float)0, alignRowNum);
+            for (uint32_t chunk = 0; chunk < this->colChunkNum; chunk++) {
+                AscendC::DataCopy(partialLocal, partialGm[chunk * this->partialRowNum + rowStart], alignRowNum);
+                event_t eventIdMte2ToV = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::MTE2_V));
+                AscendC::SetFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+                AscendC::WaitFlag<AscendC::HardEvent::MTE2_V>(eventIdMte2ToV);
+                AscendC::Add(accLocal, accLocal, partialLocal, alignRowNum);
+                event_t eventIdVToMte2 = static_cast<event_t>(pipe->FetchEventID(AscendC::HardEvent::V_MTE2));
+                AscendC::SetFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+                AscendC::WaitFlag<AscendC::HardEvent::V_MTE2>(eventIdVToMte2);
+            }
+            CopyOutFloat(que, dxGm, rowStart, accLocal, rowNum);
+        }
+    }
+
+private:
+    AscendC::TPipe* pipe;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueDy;
+    AscendC::TQue<AscendC::QuePosition::VECIN, BUFFER_NUM> inQueueCondition;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueDx1;
+    AscendC::TQue<AscendC::QuePosition::VECOUT, BUFFER_NUM> outQueueDx2;
+
+    AscendC::TBuf<AscendC::TPosition::VECCALC> condBuf; // cond不是FULL时常驻UB
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> tmp2;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> zeroBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> selBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> selFloatBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> rowSumBuf;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> acc1;
+    AscendC::TBuf<AscendC::TPosition::VECCALC> acc2;
+
+    AscendC::GlobalTensor<DTYPE_DY> dyGm;
+    AscendC::GlobalTensor<DTYPE_CONDITION> conditionGm;
+    AscendC::GlobalTensor<DTYPE_DX1> dx1Gm;
+    AscendC::GlobalTensor<DTYPE_DX2> dx2Gm;
+    AscendC::GlobalTensor<float> partial1Gm;
+    AscendC::GlobalTensor<float> partial2Gm;
+};
+
+extern "C" __global__ __aicore__ void select_v2_grad(GM_ADDR condition, GM_ADDR x1, GM_ADDR x2, GM_ADDR dy, GM_ADDR dx1, GM_ADDR dx2, GM_ADDR workspace, GM_ADDR tiling) {
+    GET_TILING_DATA(tiling_data, tiling);
+    AscendC::TPipe pipe;
+    GM_ADDR userWorkspace = AscendC::GetUserWorkspace(workspace);
+
+    // x1/x2只在tiling里提供shape，kernel不读
+    if (tiling_data.tileReduce) {
+        KernelSelectV2GradTileReduce op;
+        op.Init(condition, dy, dx1, dx2, userWorkspace, tiling_data.tileDataNum,
+                tiling_data.outerNum, tiling_data.innerNum, tiling_data.tileRowNum, tiling_data.tileColNum,
+                tiling_data.condMode, tiling_data.x1Mode, tiling_data.x2Mode,
+                &pipe);
+        op.Process();
+    } else {
+        KernelSelectV2Grad op;
+        op.Init(condition, dy, dx1, dx2, tiling_data.smallDataNum, tiling_data.finalSmallTileNum,
+                tiling_data.tileDataNum, tiling_data.smallTailDataNum, tiling_data.totalDataNum,
+                tiling_data.yShape, tiling_data.yDimNum,
+                tiling_data.condStrides, tiling_data.x1Strides, tiling_data.x2Strides, tiling_data.yStrides,
+                tiling_data.condNeedBroadcast, tiling_data.x1NeedReduce, tiling_data.x2NeedReduce,
+                tiling_data.dx1DataNum, tiling_data.dx2DataNum,
+                userWorkspace, tiling_data.accInWorkspace,
+                &pipe);
+        op.Process();
+    }
+}
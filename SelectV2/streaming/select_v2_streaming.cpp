@@ -0,0 +1,250 @@
+#include "select_v2_streaming.h"
+#include "aclnn_select_v2.h"
+
+namespace {
+const int SLOT_NUM = 2;     // 两个chunk轮转，一个在搬入时另一个在计算
+const int OPERAND_NUM = 3;  // condition、x1、x2
+
+#define CHECK_ACL(expr)              \
+    do {                             \
+        aclError ret = (expr);       \
+        if (ret != ACL_SUCCESS) {    \
+            return ret;              \
+        }                            \
+    } while (0)
+
+int64_t GetShapeSize(const std::vector<int64_t>& shape)
+{
+    int64_t size = 1;
+    for (int64_t dim : shape) {
+        size *= dim;
+    }
+    return size;
+}
+
+// 输入在y第0维上的切分方式，和tiling里的广播关系一致：
+// 右对齐后第0维和y相同的输入按行切，第0维被广播的输入整个常驻；row_select时只有一维的condition [N] 对齐y的第0维
+struct OperandLayout {
+    bool sliced;
+    int64_t rowDataNum;   // 按行切时每行的元素个数，常驻时为整个输入的元素个数
+    size_t typeSize;
+};
+
+OperandLayout GetOperandLayout(const SelectV2StreamTensor& tensor, const std::vector<int64_t>& yShape, bool rowAligned)
+{
+    OperandLayout layout;
+    const std::vector<int64_t>& shape = tensor.shape;
+    layout.sliced = !shape.empty() && yShape[0] != 1 && shape[0] == yShape[0] &&
+                    (shape.size() == yShape.size() || (rowAligned && shape.size() == 1));
+    layout.rowDataNum = layout.sliced ? GetShapeSize(shape) / shape[0] : GetShapeSize(shape);
+    layout.typeSize = aclDataTypeSize(tensor.dataType);
+    return layout;
+}
+
+aclTensor* CreateDeviceTensor(const std::vector<int64_t>& shape, aclDataType dataType, void* deviceAddr)
+{
+    std::vector<int64_t> strides(shape.size(), 1);
+    for (int64_t i = static_cast<int64_t>(shape.size()) - 2; i >= 0; i--) {
+        strides[i] = shape[i + 1] * strides[i + 1];
+    }
+    return aclCreateTensor(shape.data(), shape.size(), dataType, strides.data(), 0, aclFormat::ACL_FORMAT_ND,
+                           shape.data(), shape.size(), deviceAddr);
+}
+
+// 一个chunk在device上的全部资源，slot复用前要等上一次的计算和回写完成
+struct Slot {
+    void* operandAddr[OPERAND_NUM] {};
+    void* yAddr = nullptr;
+    void* workspaceAddr = nullptr;
+    uint64_t workspaceSize = 0;
+    aclTensor* operandTensor[OPERAND_NUM] {};
+    aclTensor* yTensor = nullptr;
+    aclrtEvent h2dDone = nullptr;
+    aclrtEvent computeDone = nullptr;
+    bool inFlight = false;
+
+    // workspace只增不减，slot空闲时才会调用
+    aclError ReserveWorkspace(uint64_t size)
+    {
+        if (size <= workspaceSize) {
+            return ACL_SUCCESS;
+        }
+        if (workspaceAddr != nullptr) {
+            aclrtFree(workspaceAddr);
+            workspaceAddr = nullptr;
+            workspaceSize = 0;
+        }
+        aclError ret = aclrtMalloc(&workspaceAddr, size, ACL_MEM_MALLOC_HUGE_FIRST);
+        if (ret == ACL_SUCCESS) {
+            workspaceSize = size;
+        }
+        return ret;
+    }
+
+    void DestroyTensors()
+    {
+        for (int i = 0; i < OPERAND_NUM; i++) {
+            if (operandTensor[i] != nullptr) {
+                aclDestroyTensor(operandTensor[i]);
+                operandTensor[i] = nullptr;
+            }
+        }
+        if (yTensor != nullptr) {
+            aclDestroyTensor(yTensor);
+            yTensor = nullptr;
+        }
+    }
+};
+
+// 出错提前返回时也要把流、事件和device内存释放掉
+struct StreamingContext {
+    aclrtStream copyStream = nullptr;
+    aclrtStream computeStream = nullptr;
+    void* residentAddr[OPERAND_NUM] {};
+    Slot slots[SLOT_NUM];
+
+    ~StreamingContext()
+    {
+        if (computeStream != nullptr) {
+            aclrtSynchronizeStream(computeStream);
+        }
+        if (copyStream != nullptr) {
+            aclrtSynchronizeStream(copyStream);
+        }
+        for (Slot& slot : slots) {
+            slot.DestroyTensors();
+            for (void* addr : slot.operandAddr) {
+                if (addr != nullptr) {
+                    aclrtFree(addr);
+                }
+            }
+            if (slot.yAddr != nullptr) {
+                aclrtFree(slot.yAddr);
+            }
+            if (slot.workspaceAddr != nullptr) {
+                aclrtFree(slot.workspaceAddr);
+            }
+            if (slot.h2dDone != nullptr) {
+                aclrtDestroyEvent(slot.h2dDone);
+            }
+            if (slot.computeDone != nullptr) {
+                aclrtDestroyEvent(slot.computeDone);
+            }
+        }
+        for (void* addr : residentAddr) {
+            if (addr != nullptr) {
+                aclrtFree(addr);
+            }
+        }
+        if (copyStream != nullptr) {
+            aclrtDestroyStream(copyStream);
+        }
+        if (computeStream != nullptr) {
+            aclrtDestroyStream(computeStream);
+        }
+    }
+};
+}
+
+aclError SelectV2Streaming(const SelectV2StreamTensor& condition, const SelectV2StreamTensor& x1,
+                           const SelectV2StreamTensor& x2, const SelectV2StreamTensor& y,
+                           const SelectV2StreamOptions& options)
+{
+    const std::vector<int64_t>& yShape = y.shape;
+    if (yShape.empty() || GetShapeSize(yShape) == 0) {
+        return ACL_SUCCESS;
+    }
+    const SelectV2StreamTensor* operands[OPERAND_NUM] = {&condition, &x1, &x2};
+    OperandLayout layouts[OPERAND_NUM];
+    for (int i = 0; i < OPERAND_NUM; i++) {
+        layouts[i] = GetOperandLayout(*operands[i], yShape, i == 0 && options.rowSelect);
+    }
+    int64_t yRowNum = yShape[0];
+    int64_t yRowDataNum = GetShapeSize(yShape) / yRowNum;
+    size_t yTypeSize = aclDataTypeSize(y.dataType);
+
+    // 1. 按chunk预算算出每个chunk的行数；只按第0维切，一行都放不下时不会超预算硬跑，直接报错
+    uint64_t rowBytes = yRowDataNum * yTypeSize;
+    for (int i = 0; i < OPERAND_NUM; i++) {
+        rowBytes += layouts[i].sliced ? layouts[i].rowDataNum * layouts[i].typeSize : 0;
+    }
+    if (rowBytes > options.chunkBytes) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    int64_t chunkRowNum = static_cast<int64_t>(options.chunkBytes / rowBytes);
+    chunkRowNum = chunkRowNum > yRowNum ? yRowNum : chunkRowNum;
+
+    // 2. 两条流：copyStream负责H2D，computeStream负责计算和回写，用事件串起来
+    StreamingContext ctx;
+    CHECK_ACL(aclrtCreateStream(&ctx.copyStream));
+    CHECK_ACL(aclrtCreateStream(&ctx.computeStream));
+    for (int i = 0; i < OPERAND_NUM; i++) {
+        uint64_t bytes = layouts[i].rowDataNum * layouts[i].typeSize;
+        if (layouts[i].sliced) {
+            for (Slot& slot : ctx.slots) {
+                CHECK_ACL(aclrtMalloc(&slot.operandAddr[i], chunkRowNum * bytes, ACL_MEM_MALLOC_HUGE_FIRST));
+            }
+        } else {
+            CHECK_ACL(aclrtMalloc(&ctx.residentAddr[i], bytes, ACL_MEM_MALLOC_HUGE_FIRST));
+            CHECK_ACL(aclrtMemcpy(ctx.residentAddr[i], bytes, operands[i]->data, bytes, ACL_MEMCPY_HOST_TO_DEVICE));
+        }
+    }
+    for (Slot& slot : ctx.slots) {
+        CHECK_ACL(aclrtMalloc(&slot.yAddr, chunkRowNum * yRowDataNum * yTypeSize, ACL_MEM_MALLOC_HUGE_FIRST));
+        CHECK_ACL(aclrtCreateEvent(&slot.h2dDone));
+        CHECK_ACL(aclrtCreateEvent(&slot.computeDone));
+    }
+
+    // 3. 逐个chunk：等slot空闲 -> H2D -> 计算 -> D2H，第k+1个chunk的H2D和第k个chunk的计算重叠
+    int64_t chunkIndex = 0;
+    for (int64_t rowStart = 0; rowStart < yRowNum; rowStart += chunkRowNum, chunkIndex++) {
+        int64_t rowNum = yRowNum - rowStart < chunkRowNum ? yRowNum - rowStart : chunkRowNum;
+        Slot& slot = ctx.slots[chunkIndex % SLOT_NUM];
+        if (slot.inFlight) {
+            CHECK_ACL(aclrtSynchronizeEvent(slot.computeDone));
+            slot.DestroyTensors();
+        }
+
+        for (int i = 0; i < OPERAND_NUM; i++) {
+            std::vector<int64_t> shape = operands[i]->shape;
+            void* addr = ctx.residentAddr[i];
+            if (layouts[i].sliced) {
+                uint64_t rowBytesOfOperand = layouts[i].rowDataNum * layouts[i].typeSize;
+                const uint8_t* src = static_cast<const uint8_t*>(operands[i]->data) + rowStart * rowBytesOfOperand;
+                CHECK_ACL(aclrtMemcpyAsync(slot.operandAddr[i], rowNum * rowBytesOfOperand, src,
+                                           rowNum * rowBytesOfOperand, ACL_MEMCPY_HOST_TO_DEVICE, ctx.copyStream));
+                shape[0] = rowNum;
+                addr = slot.operandAddr[i];
+            }
+            slot.operandTensor[i] = CreateDeviceTensor(shape, operands[i]->dataType, addr);
+        }
+        CHECK_ACL(aclrtRecordEvent(slot.h2dDone, ctx.copyStream));
+        CHECK_ACL(aclrtStreamWaitEvent(ctx.computeStream, slot.h2dDone));
+
+        std::vector<int64_t> yChunkShape = yShape;
+        yChunkShape[0] = rowNum;
+        slot.yTensor = CreateDeviceTensor(yChunkShape, y.dataType, slot.yAddr);
+
+        uint64_t workspaceSize = 0;
+        aclOpExecutor* executor = nullptr;
+        CHECK_ACL(aclnnSelectV2GetWorkspaceSize(slot.operandTensor[0], slot.operandTensor[1], slot.operandTensor[2],
+                                                nullptr, options.dstType, options.epilogueScale, options.epilogueAdd,
+                                                const_cast<char*>(options.epilogueActivation), options.rowSelect,
+                                                slot.yTensor, &workspaceSize, &executor));
+        // executor交给aclnnSelectV2后由它释放，在这之前提前返回要自己销毁
+        aclError ret = slot.ReserveWorkspace(workspaceSize);
+        if (ret != ACL_SUCCESS) {
+            aclDestroyAclOpExecutor(executor);
+            return ret;
+        }
+        CHECK_ACL(aclnnSelectV2(slot.workspaceAddr, workspaceSize, executor, ctx.computeStream));
+
+        uint64_t yBytes = rowNum * yRowDataNum * yTypeSize;
+        uint8_t* dst = static_cast<uint8_t*>(y.data) + rowStart * yRowDataNum * yTypeSize;
+        CHECK_ACL(aclrtMemcpyAsync(dst, yBytes, slot.yAddr, yBytes, ACL_MEMCPY_DEVICE_TO_HOST, ctx.computeStream));
+        CHECK_ACL(aclrtRecordEvent(slot.computeDone, ctx.computeStream));
+        slot.inFlight = true;
+    }
+    CHECK_ACL(aclrtSynchronizeStream(ctx.computeStream));
+    return ACL_SUCCESS;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "acl/acl.h"
+
+// host上的一个输入/输出；data建议用aclrtMallocHost申请，普通内存上的H2D无法和计算重叠
+struct SelectV2StreamTensor {
+    void* data;
+    std::vector<int64_t> shape;
+    aclDataType dataType;
+};
+
+struct SelectV2StreamOptions {
+    uint64_t chunkBytes = 256ULL * 1024 * 1024; // 一个chunk在device上占用的字节数上限，两个chunk轮转
+    int64_t dstType = -1;                        // 以下属性含义同SelectV2
+    float epilogueScale = 1.0f;
+    float epilogueAdd = 0.0f;
+    const char* epilogueActivation = "none";
+    bool rowSelect = false;
+};
+
+// 沿y的第0维把输出切成chunk，逐个搬入、计算、搬回host，device峰值内存约为2个chunk加上常驻的输入
+// y的一行（连同按行切的输入）超过chunkBytes时返回ACL_ERROR_INVALID_PARAM
+// 第0维被广播的输入只搬一次常驻device；chunk之间输出不重叠，结果和整体计算一致
+aclError SelectV2Streaming(const SelectV2StreamTensor& condition, const SelectV2StreamTensor& x1,
+                           const SelectV2StreamTensor& x2, const SelectV2StreamTensor& y,
+                           const SelectV2StreamOptions& options);
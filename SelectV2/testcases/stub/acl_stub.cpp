@@ -0,0 +1,380 @@
+// 在host内存上模拟device：aclrtMalloc就是malloc，异步接口按流排队，只在同步时执行
+// 调度时总是先把排在前面创建的流（select_v2_streaming里是copyStream）尽量往前推，
+// H2D会抢在允许的最早时刻执行，slot复用前少等一个事件就会覆盖还没算完的输入
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <set>
+#include <vector>
+#include "acl/acl.h"
+#include "aclnn_select_v2.h"
+#include "acl_stub.h"
+
+struct aclTensor {
+    std::vector<int64_t> shape;
+    aclDataType dataType;
+    void* data;
+};
+
+struct aclOpExecutor {
+    aclTensor condition;
+    aclTensor x1;
+    aclTensor x2;
+    aclTensor y;
+    bool rowSelect;
+    uint64_t workspaceSize;
+};
+
+namespace {
+struct Event {
+    uint64_t recordNum = 0;     // 已经下发的record次数
+    uint64_t completedNum = 0;  // 已经在流上执行到的record序号
+};
+
+struct Op {
+    std::function<void()> task;
+    Event* recordEvent = nullptr;
+    uint64_t recordSeq = 0;
+    Event* waitEvent = nullptr;
+    uint64_t waitSeq = 0;
+};
+
+struct Stream {
+    std::deque<Op> ops;
+};
+
+std::vector<Stream*> g_streams; // 按创建顺序排列，越靠前调度优先级越高
+std::set<void*> g_allocs;
+acl_stub::Stats g_stats;
+uint64_t g_workspaceSize = 0;
+bool g_failMallocArmed = false;
+bool g_failNextMalloc = false;
+
+bool IsReady(const Op& op)
+{
+    return op.waitEvent == nullptr || op.waitEvent->completedNum >= op.waitSeq;
+}
+
+// 依次把每条流推进到不能再推进为止，直到done成立；所有流都卡住说明事件依赖成环
+void RunUntil(const std::function<bool()>& done)
+{
+    while (!done()) {
+        bool progress = false;
+        for (Stream* stream : g_streams) {
+            while (!stream->ops.empty() && IsReady(stream->ops.front())) {
+                Op op = stream->ops.front();
+                stream->ops.pop_front();
+                if (op.task) {
+                    op.task();
+                }
+                if (op.recordEvent != nullptr) {
+                    op.recordEvent->completedNum = op.recordSeq;
+                }
+                progress = true;
+            }
+        }
+        if (!progress && !done()) {
+            fprintf(stderr, "acl_stub: deadlock, pending ops wait on events that are never recorded\n");
+            abort();
+        }
+    }
+}
+
+Stream* ToStream(aclrtStream stream)
+{
+    return static_cast<Stream*>(stream);
+}
+
+// 右对齐广播下y的第index个元素在输入里的偏移；rowSelect时一维的condition对齐y的第0维
+int64_t BroadcastOffset(const std::vector<int64_t>& shape, const std::vector<int64_t>& yShape, int64_t index,
+                        bool rowAligned)
+{
+    std::vector<int64_t> yIndex(yShape.size());
+    for (int64_t i = static_cast<int64_t>(yShape.size()) - 1; i >= 0; i--) {
+        yIndex[i] = index % yShape[i];
+        index /= yShape[i];
+    }
+    if (rowAligned) {
+        return yIndex[0];
+    }
+    int64_t offset = 0;
+    size_t lead = yShape.size() - shape.size();
+    for (size_t i = 0; i < shape.size(); i++) {
+        offset = offset * shape[i] + (shape[i] == 1 ? 0 : yIndex[lead + i]);
+    }
+    return offset;
+}
+
+bool IsBroadcastable(const std::vector<int64_t>& shape, const std::vector<int64_t>& yShape)
+{
+    if (shape.size() > yShape.size()) {
+        return false;
+    }
+    size_t lead = yShape.size() - shape.size();
+    for (size_t i = 0; i < shape.size(); i++) {
+        if (shape[i] != 1 && shape[i] != yShape[lead + i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int64_t GetShapeSize(const std::vector<int64_t>& shape)
+{
+    int64_t size = 1;
+    for (int64_t dim : shape) {
+        size *= dim;
+    }
+    return size;
+}
+
+// 参考实现，只支持bool的condition和float的x1/x2/y
+void ReferenceSelect(const aclOpExecutor& op)
+{
+    const std::vector<int64_t>& yShape = op.y.shape;
+    bool condRowAligned = op.rowSelect && op.condition.shape.size() == 1 && yShape.size() > 1 &&
+                          op.condition.shape[0] == yShape[0];
+    const bool* condition = static_cast<const bool*>(op.condition.data);
+    const float* x1 = static_cast<const float*>(op.x1.data);
+    const float* x2 = static_cast<const float*>(op.x2.data);
+    float* y = static_cast<float*>(op.y.data);
+    for (int64_t i = 0; i < GetShapeSize(yShape); i++) {
+        bool cond = condition[BroadcastOffset(op.condition.shape, yShape, i, condRowAligned)];
+        y[i] = cond ? x1[BroadcastOffset(op.x1.shape, yShape, i, false)] : x2[BroadcastOffset(op.x2.shape, yShape, i, false)];
+    }
+}
+}
+
+namespace acl_stub {
+Stats GetStats()
+{
+    return g_stats;
+}
+
+void Reset()
+{
+    g_stats = Stats();
+    g_workspaceSize = 0;
+    g_failMallocArmed = false;
+    g_failNextMalloc = false;
+}
+
+void SetWorkspaceSize(uint64_t size)
+{
+    g_workspaceSize = size;
+}
+
+void FailMallocAfterGetWorkspaceSize()
+{
+    g_failMallocArmed = true;
+}
+}
+
+size_t aclDataTypeSize(aclDataType dataType)
+{
+    switch (dataType) {
+        case ACL_FLOAT:
+        case ACL_INT32:
+            return 4;
+        case ACL_FLOAT16:
+            return 2;
+        case ACL_INT8:
+        case ACL_BOOL:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+aclError aclrtCreateStream(aclrtStream* stream)
+{
+    Stream* created = new Stream();
+    g_streams.push_back(created);
+    g_stats.liveStreams++;
+    *stream = created;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtDestroyStream(aclrtStream stream)
+{
+    Stream* target = ToStream(stream);
+    RunUntil([target]() { return target->ops.empty(); });
+    for (size_t i = 0; i < g_streams.size(); i++) {
+        if (g_streams[i] == target) {
+            g_streams.erase(g_streams.begin() + i);
+            break;
+        }
+    }
+    delete target;
+    g_stats.liveStreams--;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtSynchronizeStream(aclrtStream stream)
+{
+    Stream* target = ToStream(stream);
+    RunUntil([target]() { return target->ops.empty(); });
+    return ACL_SUCCESS;
+}
+
+aclError aclrtMalloc(void** devPtr, size_t size, aclrtMemMallocPolicy policy)
+{
+    (void)policy;
+    if (g_failNextMalloc) {
+        g_failNextMalloc = false;
+        return ACL_ERROR_RT_MEMORY_ALLOCATION;
+    }
+    *devPtr = malloc(size == 0 ? 1 : size);
+    g_allocs.insert(*devPtr);
+    g_stats.liveAllocs++;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtFree(void* devPtr)
+{
+    if (g_allocs.erase(devPtr) == 0) {
+        fprintf(stderr, "acl_stub: aclrtFree on unknown address %p\n", devPtr);
+        abort();
+    }
+    free(devPtr);
+    g_stats.liveAllocs--;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtMemcpy(void* dst, size_t destMax, const void* src, size_t count, aclrtMemcpyKind kind)
+{
+    (void)kind;
+    if (count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    memcpy(dst, src, count);
+    return ACL_SUCCESS;
+}
+
+aclError aclrtMemcpyAsync(void* dst, size_t destMax, const void* src, size_t count, aclrtMemcpyKind kind,
+                          aclrtStream stream)
+{
+    (void)kind;
+    if (count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    Op op;
+    op.task = [dst, src, count]() { memcpy(dst, src, count); };
+    ToStream(stream)->ops.push_back(op);
+    return ACL_SUCCESS;
+}
+
+aclError aclrtCreateEvent(aclrtEvent* event)
+{
+    *event = new Event();
+    g_stats.liveEvents++;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtDestroyEvent(aclrtEvent event)
+{
+    delete static_cast<Event*>(event);
+    g_stats.liveEvents--;
+    return ACL_SUCCESS;
+}
+
+aclError aclrtRecordEvent(aclrtEvent event, aclrtStream stream)
+{
+    Event* target = static_cast<Event*>(event);
+    Op op;
+    op.recordEvent = target;
+    op.recordSeq = ++target->recordNum;
+    ToStream(stream)->ops.push_back(op);
+    return ACL_SUCCESS;
+}
+
+aclError aclrtStreamWaitEvent(aclrtStream stream, aclrtEvent event)
+{
+    Event* target = static_cast<Event*>(event);
+    Op op;
+    op.waitEvent = target;
+    op.waitSeq = target->recordNum;
+    ToStream(stream)->ops.push_back(op);
+    return ACL_SUCCESS;
+}
+
+aclError aclrtSynchronizeEvent(aclrtEvent event)
+{
+    Event* target = static_cast<Event*>(event);
+    uint64_t seq = target->recordNum;
+    RunUntil([target, seq]() { return target->completedNum >= seq; });
+    return ACL_SUCCESS;
+}
+
+aclTensor* aclCreateTensor(const int64_t* viewDims, uint64_t viewDimsNum, aclDataType dataType, const int64_t* stride,
+                           int64_t offset, aclFormat format, const int64_t* storageDims, uint64_t storageDimsNum,
+                           void* tensorData)
+{
+    (void)stride;
+    (void)offset;
+    (void)format;
+    (void)storageDims;
+    (void)storageDimsNum;
+    g_stats.liveTensors++;
+    return new aclTensor {std::vector<int64_t>(viewDims, viewDims + viewDimsNum), dataType, tensorData};
+}
+
+aclnnStatus aclDestroyTensor(const aclTensor* tensor)
+{
+    delete tensor;
+    g_stats.liveTensors--;
+    return ACL_SUCCESS;
+}
+
+aclnnStatus aclDestroyAclOpExecutor(aclOpExecutor* executor)
+{
+    delete executor;
+    g_stats.liveExecutors--;
+    return ACL_SUCCESS;
+}
+
+aclnnStatus aclnnSelectV2GetWorkspaceSize(const aclTensor* condition, const aclTensor* x1, const aclTensor* x2,
+                                          const aclTensor* biasOptional, int64_t dstType, double epilogueScale,
+                                          double epilogueAdd, char* epilogueActivation, bool rowSelect,
+                                          const aclTensor* out, uint64_t* workspaceSize, aclOpExecutor** executor)
+{
+    (void)dstType;
+    bool plain = biasOptional == nullptr && epilogueScale == 1.0 && epilogueAdd == 0.0 &&
+                 strcmp(epilogueActivation, "none") == 0;
+    bool supported = condition->dataType == ACL_BOOL && x1->dataType == ACL_FLOAT && x2->dataType == ACL_FLOAT &&
+                     out->dataType == ACL_FLOAT;
+    bool condRowAligned = rowSelect && condition->shape.size() == 1 && out->shape.size() > 1 &&
+                          condition->shape[0] == out->shape[0];
+    if (!plain || !supported || (!condRowAligned && !IsBroadcastable(condition->shape, out->shape)) ||
+        !IsBroadcastable(x1->shape, out->shape) || !IsBroadcastable(x2->shape, out->shape)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *executor = new aclOpExecutor {*condition, *x1, *x2, *out, rowSelect, g_workspaceSize};
+    *workspaceSize = g_workspaceSize;
+    g_stats.liveExecutors++;
+    if (g_failMallocArmed) {
+        g_failMallocArmed = false;
+        g_failNextMalloc = true;
+    }
+    return ACL_SUCCESS;
+}
+
+// 和真实的两段式接口一样，executor在下发时就被消费掉，计算在流上执行到时才发生
+aclnnStatus aclnnSelectV2(void* workspace, uint64_t workspaceSize, aclOpExecutor* executor, aclrtStream stream)
+{
+    aclOpExecutor op = *executor;
+    delete executor;
+    g_stats.liveExecutors--;
+    if (workspaceSize < op.workspaceSize || (op.workspaceSize != 0 && workspace == nullptr)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    Op launch;
+    launch.task = [op]() {
+        ReferenceSelect(op);
+        g_stats.launchNum++;
+    };
+    ToStream(stream)->ops.push_back(launch);
+    return ACL_SUCCESS;
+}
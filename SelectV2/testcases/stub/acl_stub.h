@@ -0,0 +1,20 @@
+#pragma once
+// 模拟device的控制接口：统计未释放的资源、注入失败，供测试检查
+#include <cstdint>
+
+namespace acl_stub {
+struct Stats {
+    int liveAllocs = 0;     // 未释放的device内存
+    int liveTensors = 0;    // 未销毁的aclTensor
+    int liveExecutors = 0;  // 没有交给aclnnSelectV2、也没有销毁的executor
+    int liveStreams = 0;
+    int liveEvents = 0;
+    int launchNum = 0;      // 真正在流上执行的aclnnSelectV2次数
+};
+
+Stats GetStats();
+void Reset();
+void SetWorkspaceSize(uint64_t size);
+// 下一次aclnnSelectV2GetWorkspaceSize之后的第一次aclrtMalloc返回失败
+void FailMallocAfterGetWorkspaceSize();
+}
@@ -0,0 +1,62 @@
+#pragma once
+// 测试用的acl桩：只声明select_v2_streaming用到的接口，实现见acl_stub.cpp
+#include <cstddef>
+#include <cstdint>
+
+typedef int aclError;
+typedef int32_t aclnnStatus;
+typedef void* aclrtStream;
+typedef void* aclrtEvent;
+
+const aclError ACL_SUCCESS = 0;
+const aclError ACL_ERROR_INVALID_PARAM = 100000;
+const aclError ACL_ERROR_RT_MEMORY_ALLOCATION = 207001;
+
+typedef enum {
+    ACL_DT_UNDEFINED = -1,
+    ACL_FLOAT = 0,
+    ACL_FLOAT16 = 1,
+    ACL_INT8 = 2,
+    ACL_INT32 = 3,
+    ACL_BOOL = 12,
+} aclDataType;
+
+typedef enum {
+    ACL_FORMAT_ND = 2,
+} aclFormat;
+
+typedef enum {
+    ACL_MEM_MALLOC_HUGE_FIRST = 0,
+} aclrtMemMallocPolicy;
+
+typedef enum {
+    ACL_MEMCPY_HOST_TO_HOST = 0,
+    ACL_MEMCPY_HOST_TO_DEVICE = 1,
+    ACL_MEMCPY_DEVICE_TO_HOST = 2,
+    ACL_MEMCPY_DEVICE_TO_DEVICE = 3,
+} aclrtMemcpyKind;
+
+struct aclTensor;
+struct aclOpExecutor;
+
+size_t aclDataTypeSize(aclDataType dataType);
+
+aclError aclrtCreateStream(aclrtStream* stream);
+aclError aclrtDestroyStream(aclrtStream stream);
+aclError aclrtSynchronizeStream(aclrtStream stream);
+aclError aclrtMalloc(void** devPtr, size_t size, aclrtMemMallocPolicy policy);
+aclError aclrtFree(void* devPtr);
+aclError aclrtMemcpy(void* dst, size_t destMax, const void* src, size_t count, aclrtMemcpyKind kind);
+aclError aclrtMemcpyAsync(void* dst, size_t destMax, const void* src, size_t count, aclrtMemcpyKind kind,
+                          aclrtStream stream);
+aclError aclrtCreateEvent(aclrtEvent* event);
+aclError aclrtDestroyEvent(aclrtEvent event);
+aclError aclrtRecordEvent(aclrtEvent event, aclrtStream stream);
+aclError aclrtStreamWaitEvent(aclrtStream stream, aclrtEvent event);
+aclError aclrtSynchronizeEvent(aclrtEvent event);
+
+aclTensor* aclCreateTensor(const int64_t* viewDims, uint64_t viewDimsNum, aclDataType dataType, const int64_t* stride,
+                           int64_t offset, aclFormat format, const int64_t* storageDims, uint64_t storageDimsNum,
+                           void* tensorData);
+aclnnStatus aclDestroyTensor(const aclTensor* tensor);
+aclnnStatus aclDestroyAclOpExecutor(aclOpExecutor* executor);
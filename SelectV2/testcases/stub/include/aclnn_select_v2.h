@@ -0,0 +1,9 @@
+#pragma once
+// 测试用的aclnnSelectV2桩，签名和自动生成的头文件一致
+#include "acl/acl.h"
+
+aclnnStatus aclnnSelectV2GetWorkspaceSize(const aclTensor* condition, const aclTensor* x1, const aclTensor* x2,
+                                          const aclTensor* biasOptional, int64_t dstType, double epilogueScale,
+                                          double epilogueAdd, char* epilogueActivation, bool rowSelect,
+                                          const aclTensor* out, uint64_t* workspaceSize, aclOpExecutor** executor);
+aclnnStatus aclnnSelectV2(void* workspace, uint64_t workspaceSize, aclOpExecutor* executor, aclrtStream stream);
@@ -0,0 +1,69 @@
+// SelectV2Grad逐元素路径的UB规划：KernelSelectV2Grad::Init实际申请的UB不能超过tiling按ubSize算出的预算
+#include <cstdio>
+#include "select_v2_grad_tiling_calc.h"
+
+using namespace optiling;
+
+namespace {
+const uint64_t UB_SIZE = 196608; // ascend910b
+
+int g_failNum = 0;
+
+#define EXPECT(cond, ...)                                              \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);            \
+            fprintf(stderr, __VA_ARGS__);                              \
+            fprintf(stderr, "\n");                                     \
+            g_failNum++;                                               \
+        }                                                              \
+    } while (0)
+
+struct Case {
+    const char* name;
+    uint32_t dyTypeLength;
+    bool x1NeedReduce;
+    bool x2NeedReduce;
+    uint32_t dx1DataNum;
+    uint32_t dx2DataNum;
+};
+
+void TestKernelFitsInUb(const Case& c)
+{
+    SelectV2GradFallbackPlan plan = PlanSelectV2GradFallback(UB_SIZE, c.dyTypeLength, c.x1NeedReduce, c.x2NeedReduce,
+                                                             c.dx1DataNum, c.dx2DataNum);
+    EXPECT(plan.tileDataNum != 0, "%s: no room for a tile", c.name);
+    uint64_t kernelBytes = GetSelectV2GradFallbackKernelUbBytes(plan, c.dyTypeLength, c.x1NeedReduce, c.x2NeedReduce,
+                                                                c.dx1DataNum, c.dx2DataNum);
+    EXPECT(kernelBytes <= UB_SIZE, "%s: kernel allocates %llu bytes of UB, only %llu available", c.name,
+           static_cast<unsigned long long>(kernelBytes), static_cast<unsigned long long>(UB_SIZE));
+}
+}
+
+int main()
+{
+    // dy [64, 999]；999不是32的倍数，走逐元素路径。不需要规约的dx元素个数是整个dy，不能算进转回half的区域
+    const uint32_t dyDataNum = 64 * 999;
+    const Case cases[] = {
+        {"half, full x1, reduced x2", sizeof(uint16_t), false, true, dyDataNum, 999},
+        {"half, reduced x1, full x2", sizeof(uint16_t), true, false, 999, dyDataNum},
+        {"half, both reduced", sizeof(uint16_t), true, true, 999, 64},
+        {"float, full x1, reduced x2", sizeof(float), false, true, dyDataNum, 999},
+        {"half, full x1, large reduced x2 in workspace", sizeof(uint16_t), false, true, dyDataNum, dyDataNum / 2},
+    };
+    for (const Case& c : cases) {
+        TestKernelFitsInUb(c);
+    }
+
+    // 转回half的区域只按需要规约的dx取最大值
+    EXPECT(GetSelectV2GradCastDataNum(false, true, dyDataNum, 999) == 999, "cast area counts the full dx1");
+    EXPECT(GetSelectV2GradCastDataNum(true, false, 999, dyDataNum) == 999, "cast area counts the full dx2");
+    EXPECT(GetSelectV2GradCastDataNum(true, true, 999, 64) == 999, "cast area is not the larger reduced dx");
+
+    if (g_failNum != 0) {
+        fprintf(stderr, "%d check(s) failed\n", g_failNum);
+        return 1;
+    }
+    printf("all SelectV2Grad tiling tests passed\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+// SelectV2Streaming在模拟device上的测试：分chunk的结果要和整个y一次下发的结果逐字节一致，且不泄漏资源
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "acl_stub.h"
+#include "select_v2_streaming.h"
+
+namespace {
+const uint64_t WORKSPACE_SIZE = 64;      // 让每个slot都走一遍workspace的申请
+const uint64_t SINGLE_CHUNK_BYTES = ~0ULL;
+
+int g_failNum = 0;
+
+#define EXPECT(cond, ...)                                              \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);            \
+            fprintf(stderr, __VA_ARGS__);                              \
+            fprintf(stderr, "\n");                                     \
+            g_failNum++;                                               \
+        }                                                              \
+    } while (0)
+
+int64_t GetShapeSize(const std::vector<int64_t>& shape)
+{
+    int64_t size = 1;
+    for (int64_t dim : shape) {
+        size *= dim;
+    }
+    return size;
+}
+
+struct Case {
+    const char* name;
+    std::vector<int64_t> condShape;
+    std::vector<int64_t> x1Shape;
+    std::vector<int64_t> x2Shape;
+    std::vector<int64_t> yShape;
+    bool rowSelect;
+    uint64_t chunkBytes;
+    int chunkNum;  // 期望的aclnnSelectV2下发次数
+};
+
+struct HostData {
+    std::vector<uint8_t> condition;  // bool
+    std::vector<float> x1;
+    std::vector<float> x2;
+};
+
+HostData MakeInputs(const Case& c)
+{
+    HostData data;
+    data.condition.resize(GetShapeSize(c.condShape));
+    for (size_t i = 0; i < data.condition.size(); i++) {
+        data.condition[i] = (i * 7 + 1) % 3 == 0;
+    }
+    data.x1.resize(GetShapeSize(c.x1Shape));
+    for (size_t i = 0; i < data.x1.size(); i++) {
+        data.x1[i] = static_cast<float>(i) + 0.5f;
+    }
+    data.x2.resize(GetShapeSize(c.x2Shape));
+    for (size_t i = 0; i < data.x2.size(); i++) {
+        data.x2[i] = -static_cast<float>(i) - 1.0f;
+    }
+    return data;
+}
+
+aclError Run(const Case& c, HostData& data, std::vector<float>& y, uint64_t chunkBytes)
+{
+    y.assign(GetShapeSize(c.yShape), 0.0f);
+    SelectV2StreamOptions options;
+    options.chunkBytes = chunkBytes;
+    options.rowSelect = c.rowSelect;
+    return SelectV2Streaming({data.condition.data(), c.condShape, ACL_BOOL}, {data.x1.data(), c.x1Shape, ACL_FLOAT},
+                             {data.x2.data(), c.x2Shape, ACL_FLOAT}, {y.data(), c.yShape, ACL_FLOAT}, options);
+}
+
+void ExpectNoLeak(const char* name)
+{
+    acl_stub::Stats stats = acl_stub::GetStats();
+    EXPECT(stats.liveAllocs == 0, "%s: %d device buffers leaked", name, stats.liveAllocs);
+    EXPECT(stats.liveTensors == 0, "%s: %d tensors leaked", name, stats.liveTensors);
+    EXPECT(stats.liveExecutors == 0, "%s: %d executors leaked", name, stats.liveExecutors);
+    EXPECT(stats.liveStreams == 0, "%s: %d streams leaked", name, stats.liveStreams);
+    EXPECT(stats.liveEvents == 0, "%s: %d events leaked", name, stats.liveEvents);
+}
+
+void TestChunkedMatchesSingleLaunch(const Case& c)
+{
+    HostData data = MakeInputs(c);
+    std::vector<float> expected;
+    acl_stub::Reset();
+    acl_stub::SetWorkspaceSize(WORKSPACE_SIZE);
+    aclError ret = Run(c, data, expected, SINGLE_CHUNK_BYTES);
+    EXPECT(ret == ACL_SUCCESS, "%s: single launch returned %d", c.name, ret);
+    EXPECT(acl_stub::GetStats().launchNum == 1, "%s: single launch ran %d times", c.name, acl_stub::GetStats().launchNum);
+
+    std::vector<float> y;
+    acl_stub::Reset();
+    acl_stub::SetWorkspaceSize(WORKSPACE_SIZE);
+    ret = Run(c, data, y, c.chunkBytes);
+    EXPECT(ret == ACL_SUCCESS, "%s: chunked run returned %d", c.name, ret);
+    EXPECT(acl_stub::GetStats().launchNum == c.chunkNum, "%s: expected %d chunks, got %d", c.name, c.chunkNum,
+           acl_stub::GetStats().launchNum);
+    EXPECT(memcmp(y.data(), expected.data(), y.size() * sizeof(float)) == 0, "%s: chunked output differs", c.name);
+    ExpectNoLeak(c.name);
+}
+
+// y的一行放不进chunk时不应下发，也不应占着资源
+void TestRowLargerThanChunk()
+{
+    Case c {"row larger than chunk", {8, 16}, {8, 16}, {8, 16}, {8, 16}, false, 16 * sizeof(float), 0};
+    HostData data = MakeInputs(c);
+    std::vector<float> y;
+    acl_stub::Reset();
+    aclError ret = Run(c, data, y, c.chunkBytes);
+    EXPECT(ret == ACL_ERROR_INVALID_PARAM, "%s: returned %d", c.name, ret);
+    EXPECT(acl_stub::GetStats().launchNum == 0, "%s: launched %d times", c.name, acl_stub::GetStats().launchNum);
+    ExpectNoLeak(c.name);
+}
+
+// workspace申请失败时，已经拿到的executor要销毁
+void TestWorkspaceMallocFailure()
+{
+    Case c {"workspace malloc failure", {1, 16}, {10, 16}, {16}, {10, 16}, false, 3 * 128, 0};
+    HostData data = MakeInputs(c);
+    std::vector<float> y;
+    acl_stub::Reset();
+    acl_stub::SetWorkspaceSize(WORKSPACE_SIZE);
+    acl_stub::FailMallocAfterGetWorkspaceSize();
+    aclError ret = Run(c, data, y, c.chunkBytes);
+    EXPECT(ret != ACL_SUCCESS, "%s: expected an error", c.name);
+    ExpectNoLeak(c.name);
+}
+}
+
+int main()
+{
+    const Case cases[] = {
+        // condition、x2的第0维被广播，常驻device；每行 64B(y) + 64B(x1)，3行一个chunk：3+3+3+1，最后一个是尾chunk，
+        // 4个chunk轮转2个slot，第3、4个chunk复用slot前必须等前面的计算和回写完成
+        {"resident broadcast inputs", {1, 16}, {10, 16}, {16}, {10, 16}, false, 3 * 128, 4},
+        // row_select：condition [10] 对齐y的第0维，和x1、x2一起按行切；每行 1 + 3 * 128B，4行一个chunk：4+4+2
+        {"row_select condition", {10}, {10, 4, 8}, {10, 4, 8}, {10, 4, 8}, true, 4 * 385, 3},
+        // row_select只对一维的condition生效；[4,8] 右对齐到y的后两维，虽然第0维碰巧等于y的第0维也要常驻
+        {"row_select with rank-2 condition", {4, 8}, {4, 4, 8}, {4, 4, 8}, {4, 4, 8}, true, 3 * 128, 4},
+        // 所有输入都按行切，chunk正好整除
+        {"all inputs sliced", {6, 8}, {6, 8}, {6, 8}, {6, 8}, false, 2 * (8 + 3 * 32), 3},
+    };
+    for (const Case& c : cases) {
+        TestChunkedMatchesSingleLaunch(c);
+    }
+    TestRowLargerThanChunk();
+    TestWorkspaceMallocFailure();
+
+    if (g_failNum != 0) {
+        fprintf(stderr, "%d check(s) failed\n", g_failNum);
+        return 1;
+    }
+    printf("all SelectV2Streaming tests passed\n");
+    return 0;
+}
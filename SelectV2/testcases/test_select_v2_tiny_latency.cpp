@@ -0,0 +1,85 @@
+// 小张量路径的阈值检查：在TINY_DATA_NUM附近比较tiny路径和队列路径的估算耗时
+// 没有板子时用tiling报告里的单核带宽模型代替实测，两条路径用同一个模型，只看相对差距
+#include <cstdio>
+#include "select_v2_tiling_report.h"
+
+using namespace optiling;
+
+namespace {
+// 延迟目标：阈值处tiny路径的估算耗时至少比队列路径少5%，低于这个收益就不值得多维护一条kernel
+const double TINY_MIN_SAVING = 0.05;
+
+int g_failNum = 0;
+
+#define EXPECT(cond, ...)                                              \
+    do {                                                               \
+        if (!(cond)) {                                                 \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__);            \
+            fprintf(stderr, __VA_ARGS__);                              \
+            fprintf(stderr, "\n");                                     \
+            g_failNum++;                                               \
+        }                                                              \
+    } while (0)
+
+SelectV2TilingInput MakeInput(int64_t dataNum, SelectV2DataType dataType, uint64_t ubSize)
+{
+    SelectV2TilingInput input;
+    input.condShape.dims = {dataNum};
+    input.x1Shape.dims = {dataNum};
+    input.x2Shape.dims = {dataNum};
+    input.yShape.dims = {dataNum};
+    input.x1DataType = dataType;
+    input.x2DataType = dataType;
+    input.yDataType = dataType;
+    input.ubSize = ubSize;
+    return input;
+}
+
+// 阈值下最大的shape应走tiny路径，且比同一tiling下的队列路径至少快TINY_MIN_SAVING
+void TestThreshold(const SelectV2SocModel& model, SelectV2DataType dataType)
+{
+    const char* typeName = GetSelectV2TypeName(dataType);
+    SelectV2TilingInput input = MakeInput(TINY_DATA_NUM - 1, dataType, model.ubSize);
+    SelectV2TilingParam param;
+    EXPECT(CalcSelectV2Tiling(input, param), "%s %s: tiling failed", model.name, typeName);
+    EXPECT(param.tinyTensor, "%s %s: %u elements did not take the tiny path", model.name, typeName,
+           TINY_DATA_NUM - 1);
+
+    SelectV2TilingParam queuedParam = param;
+    queuedParam.tinyTensor = 0;
+    SelectV2TilingEstimate tiny = EstimateSelectV2Tiling(input, param, model);
+    SelectV2TilingEstimate queued = EstimateSelectV2Tiling(input, queuedParam, model);
+    double saving = 1.0 - tiny.timeUs / queued.timeUs;
+    printf("%-10s %-7s tiny %6.2f us  queued %6.2f us  saving %4.1f%%  tiny ub %6llu bytes\n", model.name, typeName,
+           tiny.timeUs, queued.timeUs, saving * 100, static_cast<unsigned long long>(tiny.ubBytes));
+    EXPECT(tiny.gmReadBytes == queued.gmReadBytes && tiny.gmWriteBytes == queued.gmWriteBytes,
+           "%s %s: tiny and queued paths move different amounts of GM data", model.name, typeName);
+    EXPECT(saving >= TINY_MIN_SAVING, "%s %s: tiny path saves %.1f%%, target %.1f%%", model.name, typeName,
+           saving * 100, TINY_MIN_SAVING * 100);
+    EXPECT(tiny.ubBytes <= model.ubSize, "%s %s: tiny path needs %llu bytes of UB", model.name, typeName,
+           static_cast<unsigned long long>(tiny.ubBytes));
+
+    // 到阈值就回到队列路径
+    SelectV2TilingInput atThreshold = MakeInput(TINY_DATA_NUM, dataType, model.ubSize);
+    SelectV2TilingParam atThresholdParam;
+    EXPECT(CalcSelectV2Tiling(atThreshold, atThresholdParam) && !atThresholdParam.tinyTensor,
+           "%s %s: %u elements still took the tiny path", model.name, typeName, TINY_DATA_NUM);
+}
+}
+
+int main()
+{
+    const SelectV2DataType dataTypes[] = {SelectV2DataType::FLOAT16, SelectV2DataType::FLOAT, SelectV2DataType::INT8,
+                                          SelectV2DataType::INT32};
+    for (const SelectV2SocModel& model : SELECT_V2_SOC_MODELS) {
+        for (SelectV2DataType dataType : dataTypes) {
+            TestThreshold(model, dataType);
+        }
+    }
+    if (g_failNum != 0) {
+        fprintf(stderr, "%d check(s) failed\n", g_failNum);
+        return 1;
+    }
+    printf("select_v2 tiny latency: all checks passed\n");
+    return 0;
+}
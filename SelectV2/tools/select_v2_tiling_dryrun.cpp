@@ -0,0 +1,184 @@
+// SelectV2 tiling的离线dry-run：给定shape和类型，跑一遍和TilingFunc相同的计算，打印tiling和估算结果
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "select_v2_tiling_calc.h"
+#include "select_v2_tiling_report.h"
+
+using namespace optiling;
+
+namespace {
+void PrintUsage(const char* prog)
+{
+    printf("usage: %s --cond SHAPE --x1 SHAPE --x2 SHAPE [options]\n"
+           "  SHAPE is comma separated, e.g. 8,1024; use \"\" for a scalar\n"
+           "  --dtype TYPE        x1/x2/y dtype: float16|float|int8|int32 (default float16)\n"
+           "  --x1-dtype TYPE     --x2-dtype TYPE     --y-dtype TYPE\n"
+           "  --y SHAPE           output shape (default: broadcast of cond/x1/x2)\n"
+           "  --bias SHAPE        add the optional bias input, same dtype as y\n"
+           "  --scale F --add F --act none|exp|relu\n"
+           "  --row-select        tf Select semantics for a rank-1 condition\n"
+           "  --soc NAME          ascend910|ascend910b|ascend310p|ascend310b (default ascend910b)\n"
+           "  --ub BYTES          override the UB size of the soc\n",
+           prog);
+}
+
+bool ParseShape(const char* text, TilingShape& shape)
+{
+    shape.dims.clear();
+    std::string str(text);
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find(',', start);
+        end = end == std::string::npos ? str.size() : end;
+        char* parseEnd = nullptr;
+        long long dim = strtoll(str.c_str() + start, &parseEnd, 10);
+        if (parseEnd != str.c_str() + end || dim < 0) {
+            return false;
+        }
+        shape.dims.push_back(dim);
+        start = end + 1;
+    }
+    return true;
+}
+
+bool ParseDataType(const char* text, SelectV2DataType& dataType)
+{
+    if (strcmp(text, "float16") == 0 || strcmp(text, "fp16") == 0 || strcmp(text, "half") == 0) {
+        dataType = SelectV2DataType::FLOAT16;
+    } else if (strcmp(text, "float") == 0 || strcmp(text, "float32") == 0 || strcmp(text, "fp32") == 0) {
+        dataType = SelectV2DataType::FLOAT;
+    } else if (strcmp(text, "int8") == 0) {
+        dataType = SelectV2DataType::INT8;
+    } else if (strcmp(text, "int32") == 0) {
+        dataType = SelectV2DataType::INT32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 右对齐广播，不能广播时返回false
+bool BroadcastShape(const TilingShape& a, const TilingShape& b, TilingShape& out)
+{
+    size_t dimNum = a.GetDimNum() > b.GetDimNum() ? a.GetDimNum() : b.GetDimNum();
+    out.dims.assign(dimNum, 1);
+    for (size_t i = 0; i < dimNum; i++) {
+        int64_t dimA = i < a.GetDimNum() ? a.GetDim(a.GetDimNum() - 1 - i) : 1;
+        int64_t dimB = i < b.GetDimNum() ? b.GetDim(b.GetDimNum() - 1 - i) : 1;
+        if (dimA != dimB && dimA != 1 && dimB != 1) {
+            return false;
+        }
+        out.dims[dimNum - 1 - i] = dimA == 1 ? dimB : dimA;
+    }
+    return true;
+}
+
+// y默认取x1/x2提升后的类型，和InferDataType一致
+SelectV2DataType InferYDataType(SelectV2DataType x1DataType, SelectV2DataType x2DataType)
+{
+    return x1DataType == x2DataType ? x1DataType : SelectV2DataType::FLOAT;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    SelectV2TilingInput input;
+    input.epilogueActivation = "none";
+    bool hasCond = false, hasX1 = false, hasX2 = false, hasY = false, hasYDataType = false;
+    SelectV2DataType dataType = SelectV2DataType::FLOAT16;
+    bool hasX1DataType = false, hasX2DataType = false;
+    const char* socName = "ascend910b";
+    uint64_t ubSize = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool ok = true;
+        if (strcmp(arg, "--row-select") == 0) {
+            input.rowSelect = true;
+            continue;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            PrintUsage(argv[0]);
+            return 0;
+        } else if (value == nullptr) {
+            ok = false;
+        } else if (strcmp(arg, "--cond") == 0) {
+            ok = hasCond = ParseShape(value, input.condShape);
+        } else if (strcmp(arg, "--x1") == 0) {
+            ok = hasX1 = ParseShape(value, input.x1Shape);
+        } else if (strcmp(arg, "--x2") == 0) {
+            ok = hasX2 = ParseShape(value, input.x2Shape);
+        } else if (strcmp(arg, "--y") == 0) {
+            ok = hasY = ParseShape(value, input.yShape);
+        } else if (strcmp(arg, "--bias") == 0) {
+            ok = input.hasBias = ParseShape(value, input.biasShape);
+        } else if (strcmp(arg, "--dtype") == 0) {
+            ok = ParseDataType(value, dataType);
+        } else if (strcmp(arg, "--x1-dtype") == 0) {
+            ok = hasX1DataType = ParseDataType(value, input.x1DataType);
+        } else if (strcmp(arg, "--x2-dtype") == 0) {
+            ok = hasX2DataType = ParseDataType(value, input.x2DataType);
+        } else if (strcmp(arg, "--y-dtype") == 0) {
+            ok = hasYDataType = ParseDataType(value, input.yDataType);
+        } else if (strcmp(arg, "--scale") == 0) {
+            input.epilogueScale = strtof(value, nullptr);
+        } else if (strcmp(arg, "--add") == 0) {
+            input.epilogueAddScalar = strtof(value, nullptr);
+        } else if (strcmp(arg, "--act") == 0) {
+            input.epilogueActivation = value;
+        } else if (strcmp(arg, "--soc") == 0) {
+            socName = value;
+        } else if (strcmp(arg, "--ub") == 0) {
+            ubSize = strtoull(value, nullptr, 10);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "invalid argument: %s %s\n", arg, value != nullptr ? value : "");
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (!hasCond || !hasX1 || !hasX2) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    const SelectV2SocModel* model = FindSelectV2SocModel(socName);
+    if (model == nullptr) {
+        fprintf(stderr, "unknown soc: %s\n", socName);
+        return 1;
+    }
+    input.ubSize = ubSize != 0 ? ubSize : model->ubSize;
+
+    input.x1DataType = hasX1DataType ? input.x1DataType : dataType;
+    input.x2DataType = hasX2DataType ? input.x2DataType : dataType;
+    input.yDataType = hasYDataType ? input.yDataType : InferYDataType(input.x1DataType, input.x2DataType);
+    input.biasDataType = input.yDataType;
+
+    if (!hasY) {
+        // row_select时condition对齐第0维，不参与右对齐广播
+        TilingShape xShape;
+        bool ok = BroadcastShape(input.x1Shape, input.x2Shape, xShape);
+        if (input.rowSelect && input.condShape.GetDimNum() == 1) {
+            input.yShape = xShape;
+        } else {
+            ok = ok && BroadcastShape(input.condShape, xShape, input.yShape);
+        }
+        if (!ok) {
+            fprintf(stderr, "shapes are not broadcastable\n");
+            return 1;
+        }
+    }
+
+    SelectV2TilingParam param;
+    if (!CalcSelectV2Tiling(input, param)) {
+        fprintf(stderr, "TilingFunc would fail for these shapes/dtypes/attrs\n");
+        return 1;
+    }
+    printf("%s", FormatSelectV2Tiling(input, param, model).c_str());
+    return 0;
+}